@@ -0,0 +1,97 @@
+#include "AnalysisBus.h"
+
+AnalysisBus::Slot::Slot(const String& name): name(name)
+{
+	for (auto& value : values_)
+	{
+		value.store(0.f, std::memory_order_relaxed);
+	}
+}
+
+bool AnalysisBus::Slot::claim(const void* publisher)
+{
+	const void* expected = nullptr;
+	return publisher_.compare_exchange_strong(expected, publisher) || expected == publisher;
+}
+
+void AnalysisBus::Slot::release(const void* publisher)
+{
+	const void* expected = publisher;
+	publisher_.compare_exchange_strong(expected, nullptr);
+}
+
+bool AnalysisBus::Slot::publish(const void* publisher, const Frame& frame) noexcept
+{
+	// An odd sequence tells readers a write is in progress, and is also the write lock: taken by CAS,
+	// it keeps a previous owner still finishing a block and a new one from ever writing together.
+	auto sequence = sequence_.load(std::memory_order_relaxed);
+
+	if ((sequence & 1) != 0
+		|| ! sequence_.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire,
+		                                       std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	// Checked under the lock, so a slot released and claimed again meanwhile is only written by its owner.
+	if (publisher_.load(std::memory_order_acquire) != publisher)
+	{
+		sequence_.store(sequence, std::memory_order_release);
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+
+	const int number_of_values = jmin<int>(frame.number_of_values, max_values);
+	for (int index = 0; index < number_of_values; ++index)
+	{
+		values_[index].store(frame.values[index], std::memory_order_relaxed);
+	}
+	number_of_values_.store(number_of_values, std::memory_order_relaxed);
+	publish_time_in_ms_.store(Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+
+	sequence_.store(sequence + 2, std::memory_order_release);
+	return true;
+}
+
+bool AnalysisBus::Slot::read(Frame& frame, const double max_age_in_ms) const noexcept
+{
+	const auto sequence_before = sequence_.load(std::memory_order_acquire);
+
+	if (sequence_before == 0 || (sequence_before & 1) != 0)
+	{
+		return false;
+	}
+
+	const int number_of_values = number_of_values_.load(std::memory_order_relaxed);
+	for (int index = 0; index < number_of_values; ++index)
+	{
+		frame.values[index] = values_[index].load(std::memory_order_relaxed);
+	}
+	const double publish_time_in_ms = publish_time_in_ms_.load(std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	if (sequence_.load(std::memory_order_relaxed) != sequence_before)
+	{
+		return false;
+	}
+
+	frame.number_of_values = number_of_values;
+
+	return Time::getMillisecondCounterHiRes() - publish_time_in_ms <= max_age_in_ms;
+}
+
+//==============================================================================
+AnalysisBus::Slot* AnalysisBus::get_slot(const String& name)
+{
+	const ScopedLock scoped_lock(slots_lock_);
+
+	for (auto* slot : slots_)
+	{
+		if (slot->name == name)
+		{
+			return slot;
+		}
+	}
+	return slots_.add(new Slot(name));
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Process-wide registry of named analysis slots. One "source" instance runs its
+	analyzers and publishes their values, "follower" instances subscribing to the
+	same name take them instead of computing them again; their analyzers keep
+	running only for what their own views need.
+	Slots are created on the message thread and never deleted while the bus lives,
+	so the audio thread only ever touches a slot through atomics.
+*/
+class AnalysisBus
+{
+public:
+	enum role
+	{
+		LOCAL,
+		SOURCE,
+		FOLLOWER
+	};
+
+	enum
+	{
+		max_values = 16
+	};
+
+	struct Frame
+	{
+		std::array<float, max_values> values{};
+		int number_of_values = 0;
+	};
+
+	class Slot
+	{
+	public:
+		explicit Slot(const String& name);
+
+		bool claim(const void* publisher);
+		void release(const void* publisher);
+
+		// False, writing nothing, unless publisher holds the claim and no other write is in progress.
+		bool publish(const void* publisher, const Frame& frame) noexcept;
+		bool read(Frame& frame, double max_age_in_ms) const noexcept;
+
+		const String name;
+
+	private:
+		std::atomic<const void*> publisher_{nullptr};
+		std::atomic<uint32> sequence_{0};
+		std::atomic<int> number_of_values_{0};
+		std::array<std::atomic<float>, max_values> values_{};
+		std::atomic<double> publish_time_in_ms_{0.};
+	};
+
+	AnalysisBus() = default;
+	~AnalysisBus() = default;
+
+	Slot* get_slot(const String& name);
+
+	//==============================================================================
+	static constexpr double default_max_staleness_in_ms = 50.;
+
+	// Saved with the input parameters state: the requested role as an int, and the slot's name.
+	static constexpr const char* role_property = "analysis_bus_role";
+	static constexpr const char* name_property = "analysis_bus_name";
+
+private:
+	CriticalSection slots_lock_;
+	OwnedArray<Slot> slots_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisBus)
+};
@@ -1,7 +1,19 @@
 #include "Analyzer.h"
 
-Analyzer::Analyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state, util::parameter_type type) : out_parameter(out_parameter),in_parameters_state(in_state), type(type)
+Analyzer::Analyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state,
+                   ParametersSmoother* in_parameters_smoother, util::parameter_type type) : out_parameter(out_parameter),
+	in_parameters_state(in_state), in_parameters(in_state), in_parameters_smoother(in_parameters_smoother), type(type)
 {
 }
 
+void Analyzer::set_uses_bus_value(const bool uses_bus_value) noexcept
+{
+	uses_bus_value_ = uses_bus_value;
+}
+
+bool Analyzer::uses_bus_value() const noexcept
+{
+	return uses_bus_value_;
+}
+
 
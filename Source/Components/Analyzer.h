@@ -6,17 +6,29 @@
 #include "ParametersState.h"
 #include "AudioParametersString.h"
 #include "Util.h"
+#include "ParametersSmoother.h"
 using namespace juce;
 
 class Analyzer : public AudioChainElement
 {
 public:
-	Analyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state, util::parameter_type type);
+	Analyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state,
+	         ParametersSmoother* in_parameters_smoother, util::parameter_type type);
 	~Analyzer() = default;
 
 	virtual float get_last_value() const = 0;
+	virtual void set_last_value(float value) = 0;
 	virtual String get_osc_address() const =0;
+	// Audio thread, before each block: true when get_last_value() was set from the analysis bus, so
+	// the analyzer skips computing it but keeps feeding its views.
+	void set_uses_bus_value(bool uses_bus_value) noexcept;
+	bool uses_bus_value() const noexcept;
 	AudioParameterFloat* out_parameter;
 	AudioProcessorValueTreeState* in_parameters_state;
+	RawParameters in_parameters;
+	ParametersSmoother* in_parameters_smoother;
 	util::parameter_type type;
+
+private:
+	bool uses_bus_value_ = false;
 };
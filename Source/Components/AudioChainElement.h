@@ -9,6 +9,9 @@ public:
 	~AudioChainElement() = default;
 
 	virtual void getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill) = 0;
+
+	// Shown in the DSP load breakdown.
+	virtual juce::String get_name() const = 0;
 	
 	virtual void prepareToPlay(double sampleRate, int samplesPerBlock)
 	{
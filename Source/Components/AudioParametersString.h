@@ -3,24 +3,78 @@
 
 namespace parameters
 {
+	enum parameter_index
+	{
+		VOLUME_OUT,
+		FREQUENCY_OUT,
+		THRESHOLD,
+		MIN_FREQUENCY,
+		FREQUENCY_BAND,
+		MAX_FREQUENCY,
+		FREQUENCY_SPEED,
+		VOLUME_SPEED,
+		ANALYZE_ON_PAUSE,
+		PARTIAL_1_FREQUENCY,
+		PARTIAL_1_AMPLITUDE,
+		PARTIAL_2_FREQUENCY,
+		PARTIAL_2_AMPLITUDE,
+		PARTIAL_3_FREQUENCY,
+		PARTIAL_3_AMPLITUDE,
+
+		NUMBER_OF_PARAMETERS
+	};
+
 	struct AudioParameterString
 	{
-		AudioParameterString(std::string id, std::string name);
+		const char* id;
+		const char* name;
+		parameter_index index;
+	};
 
-		AudioParameterString(std::string id);
+	inline constexpr AudioParameterString volume_out{"volume", "VOLUME", VOLUME_OUT},
+	                                      frequency_out{"frequency", "FREQUENCY", FREQUENCY_OUT},
+	                                      threshold{"threshold", "THRESHOLD", THRESHOLD},
+	                                      min_frequency{"min_frequency", "MIN FREQUENCY", MIN_FREQUENCY},
+	                                      frequency_band{"frequency_band", "FREQUENCY BAND", FREQUENCY_BAND},
+	                                      max_frequency{"max_frequency", "MAX FREQUENCY", MAX_FREQUENCY},
+	                                      frequency_speed{"frequency_speed", "FREQUENCY SPEED", FREQUENCY_SPEED},
+	                                      volume_speed{"volume_speed", "VOLUME SPEED", VOLUME_SPEED},
 
-		std::string id;
-		std::string name;
+	                                      analyze_on_pause{"analyze_on_pause", "ANALYZE ON PAUSE", ANALYZE_ON_PAUSE},
+
+	                                      partial_1_frequency{"partial_1_frequency", "PARTIAL 1 FREQUENCY", PARTIAL_1_FREQUENCY},
+	                                      partial_1_amplitude{"partial_1_amplitude", "PARTIAL 1 AMPLITUDE", PARTIAL_1_AMPLITUDE},
+	                                      partial_2_frequency{"partial_2_frequency", "PARTIAL 2 FREQUENCY", PARTIAL_2_FREQUENCY},
+	                                      partial_2_amplitude{"partial_2_amplitude", "PARTIAL 2 AMPLITUDE", PARTIAL_2_AMPLITUDE},
+	                                      partial_3_frequency{"partial_3_frequency", "PARTIAL 3 FREQUENCY", PARTIAL_3_FREQUENCY},
+	                                      partial_3_amplitude{"partial_3_amplitude", "PARTIAL 3 AMPLITUDE", PARTIAL_3_AMPLITUDE};
+
+	inline constexpr std::array<AudioParameterString, NUMBER_OF_PARAMETERS> table{
+		volume_out, frequency_out, threshold, min_frequency, frequency_band, max_frequency, frequency_speed,
+		volume_speed, analyze_on_pause, partial_1_frequency, partial_1_amplitude, partial_2_frequency,
+		partial_2_amplitude, partial_3_frequency, partial_3_amplitude
 	};
 
-	static AudioParameterString volume_out = AudioParameterString("volume"),
-	                            frequency_out = AudioParameterString("frequency"),
-	                            threshold = AudioParameterString("threshold"),
-	                            min_frequency = AudioParameterString("min_frequency"),
-	                            frequency_band = AudioParameterString("frequency_band"),
-	                            max_frequency = AudioParameterString("max_frequency"),
-	                            frequency_speed = AudioParameterString("frequency_speed"),
-	                            volume_speed = AudioParameterString("volume_speed"),
+	// Out parameters of the partial tracker, strongest partial first.
+	inline constexpr std::array<std::pair<AudioParameterString, AudioParameterString>, 3> partials{
+		{
+			{partial_1_frequency, partial_1_amplitude},
+			{partial_2_frequency, partial_2_amplitude},
+			{partial_3_frequency, partial_3_amplitude}
+		}
+	};
+
+	constexpr bool is_table_in_index_order()
+	{
+		for (size_t index = 0; index < table.size(); ++index)
+		{
+			if (table[index].index != static_cast<parameter_index>(index))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 
-	                            analyze_on_pause = AudioParameterString("analyze_on_pause");
+	static_assert(is_table_in_index_order(), "parameters::table must be ordered like parameter_index");
 }
@@ -0,0 +1,89 @@
+#include "CachedSampleSource.h"
+
+CachedSampleSource::CachedSampleSource(const File& file):
+	file_(file)
+{
+}
+
+CachedSampleSource::~CachedSampleSource()
+{
+	releaseResources();
+}
+
+void CachedSampleSource::prepareToPlay(int, const double sampleRate)
+{
+	if (decoded_sample_ == nullptr || (sampleRate > 0. && decoded_sample_->sample_rate != sampleRate))
+	{
+		decoded_sample_ = sample_cache_->get_sample(file_, sampleRate);
+	}
+	play_position_ = 0;
+}
+
+void CachedSampleSource::releaseResources()
+{
+	// The handle is dropped, so the cache may evict the buffer; prepareToPlay() takes it back from the
+	// cache, or has it converted again once evicted.
+	if (decoded_sample_ != nullptr)
+	{
+		decoded_sample_ = nullptr;
+		sample_cache_->trim();
+	}
+}
+
+void CachedSampleSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	bufferToFill.clearActiveBufferRegion();
+
+	if (decoded_sample_ == nullptr)
+	{
+		return;
+	}
+
+	const auto& buffer = decoded_sample_->buffer;
+	const int length = buffer.getNumSamples();
+	const int number_of_channels = buffer.getNumChannels();
+
+	if (length == 0 || number_of_channels == 0)
+	{
+		return;
+	}
+
+	// While the sample is still being decoded, playback stops at the end of what is ready.
+	const int number_of_samples_ready = decoded_sample_->get_number_of_samples_ready();
+
+	for (int offset = 0; offset < bufferToFill.numSamples;)
+	{
+		const int number_of_samples = jmin(bufferToFill.numSamples - offset, number_of_samples_ready - play_position_);
+
+		if (number_of_samples <= 0)
+		{
+			underruns_.fetch_add(1, std::memory_order_relaxed);
+			missing_samples_.fetch_add(bufferToFill.numSamples - offset, std::memory_order_relaxed);
+			return;
+		}
+
+		for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+		{
+			bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample + offset,
+			                              buffer, channel % number_of_channels, play_position_, number_of_samples);
+		}
+
+		offset += number_of_samples;
+		play_position_ = (play_position_ + number_of_samples) % length;
+	}
+}
+
+//==============================================================================
+void CachedSampleSource::set_read_ahead_length(double)
+{
+}
+
+int64 CachedSampleSource::get_number_of_underruns() const noexcept
+{
+	return underruns_.load(std::memory_order_relaxed);
+}
+
+int64 CachedSampleSource::get_number_of_missing_samples() const noexcept
+{
+	return missing_samples_.load(std::memory_order_relaxed);
+}
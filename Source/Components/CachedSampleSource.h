@@ -0,0 +1,45 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "ISampleSource.h"
+#include "SampleCache.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Plays a sample, looping, from the process-wide SampleCache, already converted to
+	the rate given to prepareToPlay(). The audio thread only copies from memory. It
+	starts as soon as the cache has converted a first chunk; catching up with the
+	conversion leaves the rest of the block silent, counted as an underrun. The handle
+	is held while the source is prepared, which keeps the cache from evicting the
+	buffer while it can still be read.
+*/
+class CachedSampleSource : public ISampleSource
+{
+public:
+	explicit CachedSampleSource(const File& file);
+	~CachedSampleSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+	//==============================================================================
+	void set_read_ahead_length(double read_ahead_in_seconds) override;
+
+	int64 get_number_of_underruns() const noexcept override;
+	int64 get_number_of_missing_samples() const noexcept override;
+
+private:
+	const File file_;
+
+	SharedResourcePointer<SampleCache> sample_cache_;
+	SampleCache::DecodedSample::Ptr decoded_sample_;
+	int play_position_ = 0;
+
+	std::atomic<int64> underruns_{0};
+	std::atomic<int64> missing_samples_{0};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CachedSampleSource)
+};
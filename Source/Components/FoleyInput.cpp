@@ -1,16 +1,24 @@
 #include "FoleyInput.h"
 
 
-FoleyInput::FoleyInput()
+FoleyInput::FoleyInput(): library_scanner_(LibraryScanner::get_default_libraries_directory(),
+                                            LibraryScanner::get_default_index_file())
 {
 	audio_format_manager_.registerBasicFormats();
-	files_audio_sources.reserve(max_samples_);
 
-	scan_libraries_files();
-	if (!libraries_.empty())
+	for (auto& layer : layers_)
 	{
-		set_selected_library(libraries_.at(0).name);
+		layer.voice.on_source_retired = [this](AudioSource* audio_source)
+		{
+			reclaim_sample(audio_source);
+		};
 	}
+
+	library_scanner_.on_libraries_changed = [this](const std::vector<LibraryScanner::Library>& libraries)
+	{
+		set_libraries(libraries);
+	};
+	library_scanner_.start_scan();
 }
 
 FoleyInput::~FoleyInput()
@@ -20,110 +28,535 @@ FoleyInput::~FoleyInput()
 void FoleyInput::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 {
+	const bool has_sample_rate_changed = sample_rate_ > 0. && sampleRate != sample_rate_;
 	sample_rate_ = sampleRate;
-	samples_per_block_ = samplesPerBlock;
+	samples_per_block_ = jmax(1, samplesPerBlock);
+
+	layer_buffer_.setSize(2, samples_per_block_);
+	gain_ramp_.assign(static_cast<size_t>(samples_per_block_), 0.f);
+	sample_indices_.resize(static_cast<size_t>(samples_per_block_));
+	std::iota(sample_indices_.begin(), sample_indices_.end(), 0.f);
+
+	const ScopedLock lock(sources_lock_);
+	for (auto& layer : layers_)
+	{
+		layer.voice.prepare(sample_rate_, samples_per_block_);
+
+		if (layer.selected_sample != nullptr)
+		{
+			layer.selected_sample->audio_source->prepareToPlay(samples_per_block_, sample_rate_);
+		}
+	}
+
+	// Which source a sample gets depends on the rate, and a mapped one cannot convert.
+	if (has_sample_rate_changed)
+	{
+		close_open_samples();
+		repost_layer_samples();
+	}
 }
 
 void FoleyInput::getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill)
 {
-	if (selected_sample_ != nullptr)
+	// Neutral values when unrouted: a moderate volume, and the frequency the pitch is centred on.
+	const auto* volume_analyzer = modulation_analyzers_[VOLUME];
+	const auto* frequency_analyzer = modulation_analyzers_[FREQUENCY];
+	granular_parameters_ = GranularEngine::map_modulation(
+		(volume_analyzer != nullptr) ? volume_analyzer->get_last_value() : 0.5f,
+		(frequency_analyzer != nullptr) ? frequency_analyzer->get_last_value() : 1000.f);
+
+	bufferToFill.clear();
+
+	if (layer_buffer_.getNumSamples() == 0)
 	{
-		selected_sample_->getNextAudioBlock(
-			juce::AudioSourceChannelInfo(bufferToFill));
+		// Not prepared yet.
+		return;
 	}
+
+	const int number_of_samples = bufferToFill.getNumSamples();
+	const int number_of_channels = jmin(jmax(1, bufferToFill.getNumChannels()), layer_buffer_.getNumChannels());
+
+	for (auto& layer : layers_)
+	{
+		const float target_gain = layer.gain.load(std::memory_order_relaxed)
+			* get_routed_gain(layer.routing.load(std::memory_order_relaxed));
+
+		// Layers without a sample cost nothing; they ramp in from their current gain once one is posted.
+		if (layer.voice.is_idle())
+		{
+			layer.previous_gain = target_gain;
+			continue;
+		}
+
+		// One ramp across the whole block, even when it is longer than the prepared size.
+		const float gain_step = (target_gain - layer.previous_gain) / static_cast<float>(jmax(1, number_of_samples));
+
+		for (int start_sample = 0; start_sample < number_of_samples;)
+		{
+			const int length = jmin(number_of_samples - start_sample, layer_buffer_.getNumSamples());
+			AudioBuffer<float> layer_block(layer_buffer_.getArrayOfWritePointers(), number_of_channels, length);
+
+			layer.voice.process(layer_block);
+			mix_layer(layer_block, bufferToFill, start_sample, layer.previous_gain + gain_step * start_sample,
+			          gain_step);
+			start_sample += length;
+		}
+		layer.previous_gain = target_gain;
+	}
+}
+
+String FoleyInput::get_name() const
+{
+	return "Foley input";
+}
+
+void FoleyInput::set_selected_layer(const int layer)
+{
+	selected_layer_ = jlimit(0, max_layers - 1, layer);
+}
+
+void FoleyInput::set_selected_sample(const int sample_index)
+{
+	set_layer_sample(selected_layer_, sample_index);
 }
 
-void FoleyInput::set_selected_sample(juce::AudioSource* audio_source)
+void FoleyInput::set_layer_sample(const int layer_index, const int sample_index)
 {
-	if (selected_sample_ != nullptr)
+	jassert(layer_index >= 0 && layer_index < max_layers);
+	auto& layer = layers_[static_cast<size_t>(layer_index)];
+
+	if (sample_index == layer.selected_sample_index || sample_index < 0 || sample_index >= get_number_of_samples())
 	{
-		selected_sample_->releaseResources();
+		return;
 	}
 
-	selected_sample_ = audio_source;
-	selected_sample_->prepareToPlay(samples_per_block_, sample_rate_);
+	const ScopedLock lock(sources_lock_);
+
+	auto* file_audio_source = open_sample(layer_index, sample_index);
+	if (file_audio_source == nullptr)
+	{
+		return;
+	}
+
+	// Prepared, and so read ahead, before the audio thread can see it. A sample the voice
+	// is still fading out is picked up where it is instead of being rewound under it.
+	if (file_audio_source->number_of_uses == 0)
+	{
+		file_audio_source->audio_source->prepareToPlay(samples_per_block_, sample_rate_);
+	}
+
+	if (layer.voice.post_source(file_audio_source->audio_source.get()))
+	{
+		++file_audio_source->number_of_uses;
+		layer.selected_sample = file_audio_source;
+		layer.selected_sample_index = sample_index;
+	}
+}
+
+void FoleyInput::set_layer_gain(const int layer, const float gain)
+{
+	jassert(layer >= 0 && layer < max_layers);
+	layers_[static_cast<size_t>(layer)].gain.store(jmax(0.f, gain));
+}
+
+void FoleyInput::set_layer_routing(const int layer, const modulation_source source)
+{
+	jassert(layer >= 0 && layer < max_layers);
+	layers_[static_cast<size_t>(layer)].routing.store(source);
 }
 
 void FoleyInput::set_selected_library(const String& library_name)
 {
-	const auto iterator = std::find_if(libraries_.begin(), libraries_.end(), [library_name](const Library library)
-	{
-		return library.name == library_name;
-	});
+	const auto iterator = std::find_if(libraries_.begin(), libraries_.end(),
+	                                   [library_name](const LibraryScanner::Library& library)
+	                                   {
+		                                   return library.name == library_name;
+	                                   });
 	if (iterator != libraries_.end())
 	{
-		current_library = &(*iterator);
-		scan_samples_files(current_library->path);
-		load_samples_into_reader();
+		current_library_name_ = iterator->name;
+		scan_samples_files(*iterator);
+		close_all_samples();
 	}
 }
 
 String FoleyInput::get_current_library_name() const
 {
-	return current_library->name;
+	return current_library_name_;
+}
+
+void FoleyInput::set_read_ahead_length(const double read_ahead_in_seconds)
+{
+	const ScopedLock lock(sources_lock_);
+	read_ahead_in_seconds_ = read_ahead_in_seconds;
+
+	for (const auto& file_audio_source : open_samples_)
+	{
+		file_audio_source->audio_source->set_read_ahead_length(read_ahead_in_seconds);
+	}
+}
+
+void FoleyInput::set_open_file_budget(const int max_open_files)
+{
+	const ScopedLock lock(sources_lock_);
+	max_open_files_ = jmax(1, max_open_files);
+	close_least_recently_used_samples();
+}
+
+void FoleyInput::set_crossfade_length(const double crossfade_length_in_seconds)
+{
+	for (auto& layer : layers_)
+	{
+		layer.voice.set_crossfade_length(crossfade_length_in_seconds);
+	}
+}
+
+void FoleyInput::set_playback_mode(const playback_mode mode)
+{
+	if (mode == playback_mode_)
+	{
+		return;
+	}
+	playback_mode_ = mode;
+	repost_layer_samples();
+}
+
+void FoleyInput::set_modulation_analyzer(const modulation_source source, Analyzer* analyzer)
+{
+	jassert(source > UNROUTED && source < number_of_modulation_sources);
+	modulation_analyzers_[static_cast<size_t>(source)] = analyzer;
+}
+
+bool FoleyInput::has_modulation_analyzer(const modulation_source source) const
+{
+	return source == UNROUTED || modulation_analyzers_[static_cast<size_t>(source)] != nullptr;
+}
+
+int64 FoleyInput::get_number_of_underruns() const
+{
+	const ScopedLock lock(sources_lock_);
+	int64 underruns = closed_sample_underruns_;
+	for (const auto* samples : {&open_samples_, &closing_samples_})
+	{
+		for (const auto& file_audio_source : *samples)
+		{
+			underruns += file_audio_source->audio_source->get_number_of_underruns();
+		}
+	}
+	return underruns;
+}
+
+int FoleyInput::get_number_of_samples() const
+{
+	return static_cast<int>(samples_.size());
+}
+
+const LibraryScanner::Sample& FoleyInput::get_sample(const int sample_index) const
+{
+	jassert(sample_index >= 0 && sample_index < get_number_of_samples());
+	return samples_[static_cast<size_t>(sample_index)];
+}
+
+int FoleyInput::get_selected_layer() const
+{
+	return selected_layer_;
+}
+
+int FoleyInput::get_selected_sample_index() const
+{
+	return get_layer_sample_index(selected_layer_);
+}
+
+int FoleyInput::get_layer_sample_index(const int layer) const
+{
+	jassert(layer >= 0 && layer < max_layers);
+	return layers_[static_cast<size_t>(layer)].selected_sample_index;
+}
+
+float FoleyInput::get_layer_gain(const int layer) const
+{
+	jassert(layer >= 0 && layer < max_layers);
+	return layers_[static_cast<size_t>(layer)].gain.load();
+}
+
+FoleyInput::modulation_source FoleyInput::get_layer_routing(const int layer) const
+{
+	jassert(layer >= 0 && layer < max_layers);
+	return static_cast<modulation_source>(layers_[static_cast<size_t>(layer)].routing.load());
+}
+
+FoleyInput::playback_mode FoleyInput::get_playback_mode() const
+{
+	return playback_mode_;
 }
 
 std::vector<File> FoleyInput::get_libraries_paths() const
 {
 	std::vector<File> paths;
-	for (auto library : libraries_)
+	for (const auto& library : libraries_)
 	{
 		paths.emplace_back(library.path);
 	}
 	return paths;
 }
 
-void FoleyInput::scan_libraries_files()
+void FoleyInput::set_libraries(const std::vector<LibraryScanner::Library>& libraries)
+{
+	libraries_ = libraries;
+
+	const auto current_library = std::find_if(libraries_.begin(), libraries_.end(),
+	                                          [this](const LibraryScanner::Library& library)
+	                                          {
+		                                          return library.name == current_library_name_;
+	                                          });
+
+	// The playing library is only reloaded if its samples changed.
+	if (current_library == libraries_.end())
+	{
+		if (! libraries_.empty())
+		{
+			set_selected_library(libraries_.front().name);
+		}
+	}
+	else
+	{
+		const auto previous_samples = samples_;
+		scan_samples_files(*current_library);
+
+		const bool has_same_files = std::equal(samples_.begin(), samples_.end(),
+		                                       previous_samples.begin(), previous_samples.end(),
+		                                       [](const LibraryScanner::Sample& a, const LibraryScanner::Sample& b)
+		                                       {
+			                                       return a.file == b.file;
+		                                       });
+		if (! has_same_files)
+		{
+			close_all_samples();
+		}
+	}
+
+	sendSynchronousChangeMessage();
+}
+
+
+void FoleyInput::scan_samples_files(const LibraryScanner::Library& library)
+{
+	samples_ = library.samples;
+}
+
+void FoleyInput::remove_layer_sample(Layer& layer)
+{
+	if (layer.selected_sample != nullptr)
+	{
+		const bool has_posted = layer.voice.post_source(nullptr);
+		jassert(has_posted);
+		ignoreUnused(has_posted);
+	}
+	layer.selected_sample = nullptr;
+	layer.selected_sample_index = -1;
+}
+
+void FoleyInput::close_all_samples()
+{
+	const ScopedLock lock(sources_lock_);
+	for (auto& layer : layers_)
+	{
+		remove_layer_sample(layer);
+	}
+	close_open_samples();
+}
+
+void FoleyInput::close_open_samples()
+{
+	// The audio thread must stop reading a sample before it is destroyed.
+	for (auto& file_audio_source : open_samples_)
+	{
+		if (file_audio_source->number_of_uses > 0)
+		{
+			closing_samples_.push_back(std::move(file_audio_source));
+		}
+		else
+		{
+			closed_sample_underruns_ += file_audio_source->audio_source->get_number_of_underruns();
+		}
+	}
+	open_samples_.clear();
+}
+
+void FoleyInput::repost_layer_samples()
 {
-	libraries_.clear();
+	// Each layer's sample is opened again if needed, and crossfades like any switch.
+	for (int layer_index = 0; layer_index < max_layers; ++layer_index)
+	{
+		auto& layer = layers_[static_cast<size_t>(layer_index)];
+		const int sample_index = layer.selected_sample_index;
+		layer.selected_sample_index = -1;
+		set_layer_sample(layer_index, sample_index);
+
+		if (layer.selected_sample_index < 0 && layer.selected_sample != nullptr)
+		{
+			// Not posted: the previous source keeps playing.
+			layer.selected_sample_index = sample_index;
+		}
+	}
+}
 
-	const juce::File user_documents = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory);
-	const juce::File application_repertory = user_documents.getChildFile("Whoosh");
+FoleyInput::FileAudioSource* FoleyInput::open_sample(const int layer, const int sample_index)
+{
+	const auto open_sample = std::find_if(open_samples_.begin(), open_samples_.end(),
+	                                      [this, layer, sample_index](const std::unique_ptr<FileAudioSource>& file_audio_source)
+	                                      {
+		                                      return file_audio_source->layer == layer
+			                                      && file_audio_source->sample_index == sample_index
+			                                      && file_audio_source->mode == playback_mode_;
+	                                      });
+	if (open_sample != open_samples_.end())
+	{
+		open_samples_.splice(open_samples_.begin(), open_samples_, open_sample);
+		return open_samples_.front().get();
+	}
 
-	auto directory_entrieses = application_repertory.findChildFiles(juce::File::TypesOfFileToFind::findDirectories,
-	                                                                false,
-	                                                                "*");
-	for (const auto& directory : directory_entrieses)
+	const auto& sample = get_sample(sample_index);
+	auto sample_source = create_sample_source(sample, playback_mode_);
+	if (sample_source == nullptr)
 	{
-		libraries_.emplace_back(Library(directory, directory.getFileName()));
+		return nullptr;
 	}
+
+	open_samples_.push_front(std::make_unique<FileAudioSource>(layer, sample_index, playback_mode_, sample.file,
+	                                                           std::move(sample_source)));
+	close_least_recently_used_samples();
+	return open_samples_.front().get();
 }
 
+void FoleyInput::close_least_recently_used_samples()
+{
+	// Samples the voice still uses stay open whatever their rank: the audio thread may read them.
+	for (auto iterator = open_samples_.end();
+	     static_cast<int>(open_samples_.size()) > max_open_files_ && iterator != open_samples_.begin();)
+	{
+		--iterator;
+		if ((*iterator)->number_of_uses == 0)
+		{
+			closed_sample_underruns_ += (*iterator)->audio_source->get_number_of_underruns();
+			iterator = open_samples_.erase(iterator);
+		}
+	}
+}
 
-void FoleyInput::scan_samples_files(const File library_path)
+void FoleyInput::reclaim_sample(AudioSource* audio_source)
 {
-	samples_files.clear();
+	const ScopedLock lock(sources_lock_);
+
+	for (auto* samples : {&open_samples_, &closing_samples_})
+	{
+		const auto file_audio_source = std::find_if(samples->begin(), samples->end(),
+		                                            [audio_source](const std::unique_ptr<FileAudioSource>& sample)
+		                                            {
+			                                            return sample->audio_source.get() == audio_source;
+		                                            });
+		if (file_audio_source == samples->end())
+		{
+			continue;
+		}
+
+		if (--(*file_audio_source)->number_of_uses == 0)
+		{
+			audio_source->releaseResources();
 
-	auto directory_entrieses = library_path.findChildFiles(juce::File::TypesOfFileToFind::findFiles, false,
-	                                                       "*.wav");
+			if (samples == &closing_samples_)
+			{
+				closed_sample_underruns_ += (*file_audio_source)->audio_source->get_number_of_underruns();
+				samples->erase(file_audio_source);
+			}
+		}
+		return;
+	}
+}
+
+std::unique_ptr<ISampleSource> FoleyInput::create_sample_source(const LibraryScanner::Sample& sample,
+                                                                 const playback_mode mode)
+{
+	// Samples small enough are decoded once into the shared cache, so switching back is instant.
+	// Grains need random access, so a sample too large for the cache always loops.
+	const double target_sample_rate = (sample_rate_ > 0.) ? sample_rate_ : sample.sample_rate;
+	if (sample_cache_->can_cache(sample.length_in_samples, sample.number_of_channels, sample.sample_rate,
+	                             target_sample_rate))
+	{
+		if (mode == GRANULAR)
+		{
+			return std::make_unique<GranularSampleSource>(sample.file, granular_parameters_);
+		}
+		return std::make_unique<CachedSampleSource>(sample.file);
+	}
 
-	int sample_index = 0;
-	for (const auto& file : directory_entrieses)
+	// Mapped playback cannot convert, so it only takes files already at the target rate.
+	const auto& file = sample.file;
+	if (sample.sample_rate == target_sample_rate)
 	{
-		if (sample_index < max_samples_)
+		if (auto* format = audio_format_manager_.findFormatForFileExtension(file.getFileExtension()))
 		{
-			samples_files.emplace_back(file);
+			if (auto* mapped_reader = format->createMemoryMappedReader(file))
+			{
+				return std::make_unique<MappedSampleSource>(mapped_reader, read_ahead_in_seconds_);
+			}
 		}
-		sample_index++;
 	}
+
+	// Anything else is decoded and converted to the target rate on the read-ahead thread.
+	if (auto* reader = audio_format_manager_.createReaderFor(file))
+	{
+		return std::make_unique<ReadAheadAudioSource>(new ResamplingReaderSource(reader), true,
+		                                              static_cast<int>(reader->numChannels), read_ahead_in_seconds_);
+	}
+	return nullptr;
 }
 
-void FoleyInput::remove_selected_sample()
+float FoleyInput::get_routed_gain(const int source) const
 {
-	selected_sample_ = nullptr;
+	const auto* analyzer = (source > UNROUTED && source < number_of_modulation_sources)
+		                       ? modulation_analyzers_[static_cast<size_t>(source)]
+		                       : nullptr;
+	if (analyzer == nullptr)
+	{
+		return 1.f;
+	}
+
+	const float value = analyzer->get_last_value();
+	if (source == FREQUENCY)
+	{
+		// Octaves above 50 Hz, over the nine up to 25.6 kHz: the brighter the sidechain, the louder.
+		return jlimit(0.f, 1.f, std::log2(jmax(50.f, value) / 50.f) / 9.f);
+	}
+	return jlimit(0.f, 1.f, value);
 }
 
-void FoleyInput::load_samples_into_reader()
+void FoleyInput::mix_layer(const AudioBuffer<float>& layer_block, AudioBuffer<float>& buffer, const int start_sample,
+                           const float start_gain, const float gain_step)
 {
-	files_audio_sources.clear();
-	remove_selected_sample();
+	const int length = layer_block.getNumSamples();
+	const bool is_ramping = gain_step != 0.f;
+
+	// The ramp is built once, then shared by every channel.
+	if (is_ramping)
+	{
+		FloatVectorOperations::copyWithMultiply(gain_ramp_.data(), sample_indices_.data(), gain_step, length);
+		FloatVectorOperations::add(gain_ramp_.data(), start_gain, length);
+	}
 
-	for (const auto& samples_file : samples_files)
+	for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
 	{
-		auto* reader = audio_format_manager_.createReaderFor(samples_file);
+		// Past the layer's channels, outputs repeat its last one.
+		const auto* source = layer_block.getReadPointer(jmin(channel, layer_block.getNumChannels() - 1));
+		auto* destination = buffer.getWritePointer(channel, start_sample);
 
-		files_audio_sources.emplace_back(
-			std::make_unique<FoleyInput::FileAudioSource>(
-				samples_file, reader));
+		if (is_ramping)
+		{
+			FloatVectorOperations::addWithMultiply(destination, source, gain_ramp_.data(), length);
+		}
+		else
+		{
+			FloatVectorOperations::addWithMultiply(destination, source, start_gain, length);
+		}
 	}
 }
@@ -2,72 +2,179 @@
 #include <JuceHeader.h>
 #include <filesystem>
 #include "AudioChainElement.h"
+#include "ReadAheadAudioSource.h"
+#include "ResamplingReaderSource.h"
+#include "MappedSampleSource.h"
+#include "CachedSampleSource.h"
+#include "GranularSampleSource.h"
+#include "Analyzer.h"
+#include "LibraryScanner.h"
+#include "SampleVoice.h"
 
 using namespace juce;
 
-class FoleyInput : public AudioChainElement
+// Libraries arrive asynchronously from a LibraryScanner; a change message follows each update.
+// Samples are only described by the scan: a reader is opened when a sample is selected, and
+// at most max_open_files_ stay open, the least recently selected being closed first.
+// Up to max_layers samples play at once, each through its own SampleVoice: a source posted
+// to a voice is only released or closed once the voice has retired it, on its reclaim thread.
+// Each layer's gain can follow one analyzer output, so an air, a tone and a sub layer react
+// to different parts of the sidechain.
+class FoleyInput : public AudioChainElement,
+                   public ChangeBroadcaster
 {
 public:
+	// LOOP plays the sample as it is; GRANULAR scatters grains of it, driven by the analyzers.
+	enum playback_mode
+	{
+		LOOP,
+		GRANULAR
+	};
+
+	// What scales a layer's gain: nothing, or one of the analyzers' outputs.
+	enum modulation_source
+	{
+		UNROUTED,
+		VOLUME,
+		BAND_ENERGY,
+		FREQUENCY,
+		number_of_modulation_sources
+	};
+
+	enum
+	{
+		max_layers = 4
+	};
+
 	FoleyInput();
 	~FoleyInput();
 
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
 	void getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill) override;
+	String get_name() const override;
 
+	// Short samples play from the shared cache; longer uncompressed files from a memory map,
+	// anything else through the read-ahead FIFO.
 	struct FileAudioSource
 	{
-		FileAudioSource(File file, AudioFormatReader* format_reader)
-			: file(std::move(file)),
-			  audio_source(std::make_unique<AudioFormatReaderSource>(format_reader, true))
+		FileAudioSource(int layer, int sample_index, playback_mode mode, File file,
+		                std::unique_ptr<ISampleSource> audio_source)
+			: layer(layer),
+			  sample_index(sample_index),
+			  mode(mode),
+			  file(std::move(file)),
+			  audio_source(std::move(audio_source))
 		{
-			audio_source->setLooping(true);
 		}
 
 		~FileAudioSource() = default;
 
+		// A source keeps one play position, so layers never share one.
+		int layer;
+		int sample_index;
+		playback_mode mode;
 		juce::File file;
-		std::unique_ptr<AudioFormatReaderSource> audio_source;
+		std::unique_ptr<ISampleSource> audio_source;
+		// Posts to the voice it has not retired yet; guarded by sources_lock_.
+		int number_of_uses = 0;
 	};
 
-
-	std::vector<std::unique_ptr<FileAudioSource>> files_audio_sources;
-
-	void set_selected_sample(juce::AudioSource*);
+	// The selection API acts on the selected layer.
+	void set_selected_layer(int layer);
+	void set_selected_sample(int sample_index);
+	void set_layer_sample(int layer, int sample_index);
+	void set_layer_gain(int layer, float gain);
+	void set_layer_routing(int layer, modulation_source source);
 	void set_selected_library(const String& library_name);
+	void set_read_ahead_length(double read_ahead_in_seconds);
+	void set_open_file_budget(int max_open_files);
+	void set_crossfade_length(double crossfade_length_in_seconds);
+	void set_playback_mode(playback_mode mode);
+	// Read on the audio thread at each block: set them before playback starts. A source left null
+	// leaves the layers routed to it unmodulated.
+	void set_modulation_analyzer(modulation_source source, Analyzer* analyzer);
 	//====================================================================================
 	String get_current_library_name() const;
 	std::vector<File> get_libraries_paths() const;
+	int64 get_number_of_underruns() const;
+	// Whether layers routed to this source are modulated; always true when unrouted.
+	bool has_modulation_analyzer(modulation_source source) const;
+
+	int get_number_of_samples() const;
+	const LibraryScanner::Sample& get_sample(int sample_index) const;
+	int get_selected_layer() const;
+	int get_selected_sample_index() const;
+	int get_layer_sample_index(int layer) const;
+	float get_layer_gain(int layer) const;
+	modulation_source get_layer_routing(int layer) const;
+	playback_mode get_playback_mode() const;
 
 private:
-	struct Library
+	struct Layer
 	{
-		Library() = default;
+		SampleVoice voice;
+		std::atomic<float> gain{1.f};
+		std::atomic<int> routing{UNROUTED};
 
-		Library(const File& path, const String& name)
-			: path(path),
-			  name(name)
-		{
-		}
+		// Message thread only.
+		int selected_sample_index = -1;
+		FileAudioSource* selected_sample = nullptr;
 
-		File path;
-		String name;
+		// Audio thread only: where the previous block's gain ramp ended.
+		float previous_gain = 0.f;
 	};
 
+	void set_libraries(const std::vector<LibraryScanner::Library>& libraries);
+	void scan_samples_files(const LibraryScanner::Library& library);
+	void remove_layer_sample(Layer& layer);
+	void close_all_samples();
+	void close_open_samples();
+	void repost_layer_samples();
+	FileAudioSource* open_sample(int layer, int sample_index);
+	void close_least_recently_used_samples();
+	void reclaim_sample(AudioSource* audio_source);
+	std::unique_ptr<ISampleSource> create_sample_source(const LibraryScanner::Sample& sample, playback_mode mode);
+	float get_routed_gain(int source) const;
+	void mix_layer(const AudioBuffer<float>& layer_block, AudioBuffer<float>& buffer, int start_sample,
+	               float start_gain, float gain_step);
 	//====================================================================================
-	void scan_libraries_files();
-	void scan_samples_files(File library_path);
-	void remove_selected_sample();
-	void load_samples_into_reader();
-	//====================================================================================
-	Library* current_library{};
-	std::vector<juce::File> samples_files;
-	std::vector<Library> libraries_;
+	String current_library_name_;
+	std::vector<LibraryScanner::Sample> samples_;
+	int selected_layer_ = 0;
+
+	// Taken on the message thread and the reclaim thread, never on the audio thread.
+	mutable CriticalSection sources_lock_;
+	// Most recently selected first.
+	std::list<std::unique_ptr<FileAudioSource>> open_samples_;
+	// Closed while the voice still used them: destroyed once retired.
+	std::list<std::unique_ptr<FileAudioSource>> closing_samples_;
+	// Underruns of the samples destroyed so far, so the total never goes backwards.
+	int64 closed_sample_underruns_ = 0;
+	std::vector<LibraryScanner::Library> libraries_;
 	juce::AudioFormatManager audio_format_manager_;
 	//====================================================================================
 	double sample_rate_{};
 	int samples_per_block_{};
 
-	int max_samples_ = 10;
+	playback_mode playback_mode_ = LOOP;
+	std::array<Analyzer*, number_of_modulation_sources> modulation_analyzers_{};
+	// Written at the start of each block, read by the granular sources during it.
+	GranularEngine::Parameters granular_parameters_;
+
+	int max_open_files_ = 8;
+	double read_ahead_in_seconds_ = 2.;
+
+	SharedResourcePointer<SampleCache> sample_cache_;
+
+	// Sized in prepareToPlay, so mixing the layers never allocates.
+	AudioBuffer<float> layer_buffer_;
+	// 0, 1, 2...: scaled and offset into each block's gain ramp.
+	std::vector<float> sample_indices_;
+	std::vector<float> gain_ramp_;
+
+	// After the sources, so their voices' reclaim callbacks stop before they are destroyed.
+	std::array<Layer, max_layers> layers_;
 
-	juce::AudioSource* selected_sample_ = nullptr;
+	// Last, so its thread stops before anything it reports to is destroyed.
+	LibraryScanner library_scanner_;
 };
@@ -29,6 +29,11 @@ void GainProcess::prepareToPlay(double sampleRate, int samplesPerBlock)
 	AudioChainElement::prepareToPlay(sampleRate, samplesPerBlock);
 }
 
+juce::String GainProcess::get_name() const
+{
+	return "Gain";
+}
+
 GainProcess::Interpolation::Interpolation(const point start, const point end): y_range(end.y - start.y),
                                                                                x_range(end.x - start.x),
                                                                                step(y_range / x_range),
@@ -11,6 +11,7 @@ public:
 	//========================================================================================================================
 	void getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill) override;
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+	juce::String get_name() const override;
 
 
 private:
@@ -0,0 +1,214 @@
+#include "GranularEngine.h"
+
+GranularEngine::Parameters GranularEngine::map_modulation(const float volume, const float frequency_in_hz)
+{
+	Parameters parameters;
+
+	const float intensity = jlimit(0.f, 1.f, volume);
+	parameters.density_in_grains_per_second = 10.f + 590.f * intensity;
+	parameters.scan_speed = 0.25f + 1.75f * intensity;
+	parameters.grain_length_in_seconds = 0.2f - 0.1f * intensity;
+
+	// Half an octave of pitch per octave of the tracked frequency, around 1 kHz.
+	const float octaves = std::log2(jmax(20.f, frequency_in_hz) / 1000.f);
+	parameters.pitch_ratio = jlimit(0.25f, 4.f, std::exp2(0.5f * octaves));
+
+	return parameters;
+}
+
+//==============================================================================
+GranularEngine::GranularEngine()
+{
+	for (int index = 0; index <= window_table_size; ++index)
+	{
+		window_table_[static_cast<size_t>(index)] = 0.5f - 0.5f * std::cos(
+			MathConstants<float>::twoPi * static_cast<float>(index) / window_table_size);
+	}
+	reset();
+}
+
+void GranularEngine::prepare(const double sample_rate, const int maximum_block_size)
+{
+	sample_rate_ = (sample_rate > 0.) ? sample_rate : 44100.;
+	scratch_.assign(static_cast<size_t>(jmax(1, maximum_block_size)), 0.f);
+	reset();
+}
+
+void GranularEngine::reset()
+{
+	number_of_active_grains_ = 0;
+	number_of_free_grains_ = max_grains;
+	for (int index = 0; index < max_grains; ++index)
+	{
+		free_grains_[static_cast<size_t>(index)] = max_grains - 1 - index;
+	}
+	scan_position_ = 0.;
+	grains_to_start_ = 0.;
+}
+
+void GranularEngine::process(const AudioBuffer<float>& sample, const int sample_length,
+                             const AudioSourceChannelInfo& output, const Parameters& parameters)
+{
+	jassert(sample_length <= sample.getNumSamples());
+
+	if (sample_length <= 0 || sample.getNumChannels() == 0 || scratch_.empty())
+	{
+		return;
+	}
+
+	// Blocks larger than prepared for are split rather than allocated for.
+	const int chunk_size = static_cast<int>(scratch_.size());
+	for (int offset = 0; offset < output.numSamples; offset += chunk_size)
+	{
+		process_chunk(sample, sample_length, *output.buffer, output.startSample + offset,
+		              jmin(chunk_size, output.numSamples - offset), parameters);
+	}
+}
+
+int GranularEngine::get_number_of_active_grains() const noexcept
+{
+	return number_of_active_grains_;
+}
+
+//==============================================================================
+void GranularEngine::process_chunk(const AudioBuffer<float>& sample, const int sample_length,
+                                   AudioBuffer<float>& output, const int start_sample, const int number_of_samples,
+                                   const Parameters& parameters)
+{
+	start_grains(sample.getNumChannels(), sample_length, number_of_samples, parameters);
+
+	const int number_of_output_channels = output.getNumChannels();
+
+	for (int active_index = 0; active_index < number_of_active_grains_;)
+	{
+		const int grain_index = active_grains_[static_cast<size_t>(active_index)];
+		auto& grain = grains_[static_cast<size_t>(grain_index)];
+
+		const int delay = grain.delay;
+		const int length = render_grain(grain, sample, sample_length, number_of_samples);
+
+		for (int channel = 0; channel < number_of_output_channels; ++channel)
+		{
+			const float gain = (number_of_output_channels == 1)
+				                   ? 0.5f * (grain.left_gain + grain.right_gain)
+				                   : (channel % 2 == 0 ? grain.left_gain : grain.right_gain);
+
+			FloatVectorOperations::addWithMultiply(output.getWritePointer(channel, start_sample + delay),
+			                                       scratch_.data(), gain, length);
+		}
+
+		if (grain.remaining_samples == 0)
+		{
+			// Swapped out, so the active list stays packed.
+			active_grains_[static_cast<size_t>(active_index)] = active_grains_[static_cast<size_t>(--number_of_active_grains_)];
+			free_grains_[static_cast<size_t>(number_of_free_grains_++)] = grain_index;
+		}
+		else
+		{
+			++active_index;
+		}
+	}
+
+	scan_position_ = std::fmod(scan_position_ + parameters.scan_speed * number_of_samples, sample_length);
+}
+
+void GranularEngine::start_grains(const int number_of_sample_channels, const int sample_length,
+                                  const int number_of_samples, const Parameters& parameters)
+{
+	grains_to_start_ += parameters.density_in_grains_per_second * number_of_samples / sample_rate_;
+
+	const int length_in_samples = jmax(16, roundToInt(parameters.grain_length_in_seconds * sample_rate_));
+	const double jitter_in_samples = parameters.position_jitter_in_seconds * sample_rate_;
+
+	// Overlapping grains add up: the gain keeps the density from changing the level much.
+	const double overlap = parameters.density_in_grains_per_second * parameters.grain_length_in_seconds;
+	const float grain_gain = static_cast<float>(1. / std::sqrt(jmax(1., overlap)));
+
+	for (; grains_to_start_ >= 1.; grains_to_start_ -= 1.)
+	{
+		if (number_of_free_grains_ == 0)
+		{
+			// The pool is full: the grains that do not fit are dropped, not postponed.
+			grains_to_start_ = 0.;
+			break;
+		}
+
+		const int grain_index = free_grains_[static_cast<size_t>(--number_of_free_grains_)];
+		active_grains_[static_cast<size_t>(number_of_active_grains_++)] = grain_index;
+		auto& grain = grains_[static_cast<size_t>(grain_index)];
+
+		const double position = scan_position_ + (2. * random_.nextDouble() - 1.) * jitter_in_samples;
+		grain.position = position - sample_length * std::floor(position / sample_length);
+		grain.increment = parameters.pitch_ratio;
+		grain.window_phase = 0.;
+		grain.window_increment = static_cast<double>(window_table_size) / length_in_samples;
+		grain.remaining_samples = length_in_samples;
+		grain.delay = random_.nextInt(number_of_samples);
+		grain.channel = random_.nextInt(number_of_sample_channels);
+
+		const float pan = MathConstants<float>::halfPi
+			* (0.5f + parameters.stereo_spread * (random_.nextFloat() - 0.5f));
+		grain.left_gain = grain_gain * std::cos(pan);
+		grain.right_gain = grain_gain * std::sin(pan);
+	}
+}
+
+int GranularEngine::render_grain(Grain& grain, const AudioBuffer<float>& sample, const int sample_length,
+                                 const int number_of_samples)
+{
+	const int length = jmin(number_of_samples - grain.delay, grain.remaining_samples);
+	const float* source = sample.getReadPointer(grain.channel);
+	float* destination = scratch_.data();
+
+	for (int rendered = 0; rendered < length;)
+	{
+		// Runs that never read past the last sample skip the wrap checks entirely.
+		const double position = grain.position;
+		const double window_phase = grain.window_phase;
+		const int run = jmin(length - rendered,
+		                     jmax(0, static_cast<int>((sample_length - 1 - position) / grain.increment)));
+
+		// 32.32 fixed point relative to the run's first sample, so it cannot overflow.
+		const float* run_source = source + static_cast<int>(position);
+		const int64 fixed_increment = static_cast<int64>(grain.increment * 4294967296.);
+		const int64 fixed_window_increment = static_cast<int64>(grain.window_increment * 4294967296.);
+		int64 fixed_position = static_cast<int64>((position - std::floor(position)) * 4294967296.);
+		int64 fixed_window_phase = static_cast<int64>(window_phase * 4294967296.);
+
+		for (int index = 0; index < run; ++index)
+		{
+			const int integer_position = static_cast<int>(fixed_position >> 32);
+			const float fraction = static_cast<float>(fixed_position & 0xffffffff) * (1.f / 4294967296.f);
+			const float value = run_source[integer_position]
+				+ fraction * (run_source[integer_position + 1] - run_source[integer_position]);
+
+			destination[rendered + index] = value * window_table_[static_cast<size_t>(fixed_window_phase >> 32)];
+
+			fixed_position += fixed_increment;
+			fixed_window_phase += fixed_window_increment;
+		}
+
+		rendered += run;
+		grain.position = position + run * grain.increment;
+		grain.window_phase = window_phase + run * grain.window_increment;
+
+		if (rendered < length)
+		{
+			// The last sample interpolates towards the first, then the read wraps around.
+			const int integer_position = static_cast<int>(grain.position);
+			const int next_position = (integer_position + 1 < sample_length) ? integer_position + 1 : 0;
+			const float fraction = static_cast<float>(grain.position - integer_position);
+			const float value = source[integer_position] + fraction * (source[next_position] - source[integer_position]);
+
+			destination[rendered++] = value * window_table_[static_cast<size_t>(grain.window_phase)];
+
+			grain.position = std::fmod(grain.position + grain.increment, static_cast<double>(sample_length));
+			grain.window_phase += grain.window_increment;
+		}
+	}
+
+	grain.remaining_samples -= length;
+	grain.delay = 0;
+
+	return length;
+}
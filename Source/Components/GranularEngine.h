@@ -0,0 +1,88 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Granular playback of a sample held in memory, for whooshes that follow the
+	sidechain. Grains come from a fixed pool and are windowed through a precomputed
+	Hann table, so nothing is allocated once prepared. Each grain is a mono slice of
+	one channel of the sample, read at its own pitch and panned at random; it is
+	rendered into a scratch block then mixed into the output with vectorised
+	multiply-adds. A scan head moves through the sample, and grains start around it.
+*/
+class GranularEngine
+{
+public:
+	struct Parameters
+	{
+		float density_in_grains_per_second = 20.f;
+		float grain_length_in_seconds = 0.1f;
+		float pitch_ratio = 1.f;
+		// Speed of the scan head, 1 being the sample's own speed.
+		float scan_speed = 1.f;
+		float position_jitter_in_seconds = 0.05f;
+		// 0 keeps every grain centred, 1 spreads them across the whole stereo field.
+		float stereo_spread = 0.5f;
+	};
+
+	// Louder sidechain: denser, faster-moving grains; higher frequency: higher pitch.
+	static Parameters map_modulation(float volume, float frequency_in_hz);
+
+	//==============================================================================
+	GranularEngine();
+
+	void prepare(double sample_rate, int maximum_block_size);
+	void reset();
+
+	// Adds the grains to the given region of the output, reading only the first sample_length samples.
+	void process(const AudioBuffer<float>& sample, int sample_length, const AudioSourceChannelInfo& output,
+	             const Parameters& parameters);
+
+	int get_number_of_active_grains() const noexcept;
+
+	enum
+	{
+		max_grains = 512,
+		window_table_size = 1024
+	};
+
+private:
+	struct Grain
+	{
+		double position = 0.;
+		double increment = 1.;
+		double window_phase = 0.;
+		double window_increment = 0.;
+		int remaining_samples = 0;
+		// Samples of the current block to wait before the grain starts.
+		int delay = 0;
+		int channel = 0;
+		float left_gain = 0.f;
+		float right_gain = 0.f;
+	};
+
+	void process_chunk(const AudioBuffer<float>& sample, int sample_length, AudioBuffer<float>& output,
+	                   int start_sample, int number_of_samples, const Parameters& parameters);
+	void start_grains(int number_of_sample_channels, int sample_length, int number_of_samples,
+	                  const Parameters& parameters);
+	int render_grain(Grain& grain, const AudioBuffer<float>& sample, int sample_length, int number_of_samples);
+	//==============================================================================
+	std::array<Grain, max_grains> grains_;
+	std::array<int, max_grains> active_grains_{};
+	std::array<int, max_grains> free_grains_{};
+	int number_of_active_grains_ = 0;
+	int number_of_free_grains_ = 0;
+
+	std::array<float, window_table_size + 1> window_table_{};
+	std::vector<float> scratch_;
+
+	double sample_rate_ = 44100.;
+	double scan_position_ = 0.;
+	double grains_to_start_ = 0.;
+
+	Random random_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GranularEngine)
+};
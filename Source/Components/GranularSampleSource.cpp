@@ -0,0 +1,68 @@
+#include "GranularSampleSource.h"
+
+GranularSampleSource::GranularSampleSource(const File& file, const GranularEngine::Parameters& parameters):
+	file_(file),
+	parameters_(parameters)
+{
+}
+
+GranularSampleSource::~GranularSampleSource()
+{
+	releaseResources();
+}
+
+void GranularSampleSource::prepareToPlay(const int samplesPerBlockExpected, const double sampleRate)
+{
+	if (decoded_sample_ == nullptr || (sampleRate > 0. && decoded_sample_->sample_rate != sampleRate))
+	{
+		decoded_sample_ = sample_cache_->get_sample(file_, sampleRate);
+	}
+	engine_.prepare(sampleRate, samplesPerBlockExpected);
+}
+
+void GranularSampleSource::releaseResources()
+{
+	// The handle is dropped, so the cache may evict the buffer; prepareToPlay() takes it back from the
+	// cache, or has it converted again once evicted.
+	if (decoded_sample_ != nullptr)
+	{
+		decoded_sample_ = nullptr;
+		sample_cache_->trim();
+	}
+}
+
+void GranularSampleSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	bufferToFill.clearActiveBufferRegion();
+
+	if (decoded_sample_ == nullptr)
+	{
+		return;
+	}
+
+	// Grains are taken from the part already converted, which grows while decoding runs.
+	const int number_of_samples_ready = decoded_sample_->get_number_of_samples_ready();
+	if (number_of_samples_ready == 0)
+	{
+		underruns_.fetch_add(1, std::memory_order_relaxed);
+		missing_samples_.fetch_add(bufferToFill.numSamples, std::memory_order_relaxed);
+		return;
+	}
+
+	engine_.process(decoded_sample_->buffer, number_of_samples_ready, bufferToFill, parameters_);
+}
+
+//==============================================================================
+void GranularSampleSource::set_read_ahead_length(double)
+{
+}
+
+int64 GranularSampleSource::get_number_of_underruns() const noexcept
+{
+	return underruns_.load(std::memory_order_relaxed);
+}
+
+int64 GranularSampleSource::get_number_of_missing_samples() const noexcept
+{
+	return missing_samples_.load(std::memory_order_relaxed);
+}
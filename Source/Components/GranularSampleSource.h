@@ -0,0 +1,45 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "ISampleSource.h"
+#include "SampleCache.h"
+#include "GranularEngine.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Plays a sample from the process-wide SampleCache through a GranularEngine. The
+	grain parameters are read each block from the given Parameters, which the owner
+	updates on the audio thread before asking for the block. Grains only read the
+	part of the sample the cache has converted so far.
+*/
+class GranularSampleSource : public ISampleSource
+{
+public:
+	GranularSampleSource(const File& file, const GranularEngine::Parameters& parameters);
+	~GranularSampleSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+	//==============================================================================
+	void set_read_ahead_length(double read_ahead_in_seconds) override;
+
+	int64 get_number_of_underruns() const noexcept override;
+	int64 get_number_of_missing_samples() const noexcept override;
+
+private:
+	const File file_;
+	const GranularEngine::Parameters& parameters_;
+
+	SharedResourcePointer<SampleCache> sample_cache_;
+	SampleCache::DecodedSample::Ptr decoded_sample_;
+	GranularEngine engine_;
+
+	std::atomic<int64> underruns_{0};
+	std::atomic<int64> missing_samples_{0};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GranularSampleSource)
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+// A foley sample as the audio thread plays it: getNextAudioBlock() never waits for the disk.
+// releaseResources() is only called once the voice has retired the source, so the audio thread
+// no longer reads it: what prepareToPlay() acquired may be freed there, and is acquired again by
+// the next prepareToPlay().
+class ISampleSource : public AudioSource
+{
+public:
+	virtual void set_read_ahead_length(double read_ahead_in_seconds) = 0;
+
+	// Blocks that had to play data which was not read ahead yet.
+	virtual int64 get_number_of_underruns() const noexcept = 0;
+	virtual int64 get_number_of_missing_samples() const noexcept = 0;
+};
@@ -4,9 +4,9 @@ class ISpectrumAnalyzer
 {
 public:
 	virtual void push_next_sample_into_fifo(float sample) noexcept = 0;
-	virtual void calculate_next_frame_of_spectrum()= 0;
+	virtual bool calculate_next_frame_of_spectrum()= 0;
 
-	virtual void calculate_spectrum()= 0;
+	virtual bool calculate_spectrum()= 0;
 	virtual void add_current_spectrum_to_accumulator_buffer()= 0;
 	virtual void calculate_mean_fft_data()= 0;
 
@@ -0,0 +1,226 @@
+#include "LibraryScanner.h"
+
+LibraryScanner::LibraryScanner(const File& libraries_directory, const File& index_file):
+	Thread("Foley library scan"),
+	libraries_directory_(libraries_directory),
+	index_file_(index_file)
+{
+	audio_format_manager_.registerBasicFormats();
+}
+
+LibraryScanner::~LibraryScanner()
+{
+	stopThread(4000);
+	cancelPendingUpdate();
+}
+
+void LibraryScanner::start_scan()
+{
+	if (! isThreadRunning())
+	{
+		startThread(3);
+	}
+}
+
+File LibraryScanner::get_default_libraries_directory()
+{
+	return File::getSpecialLocation(File::userDocumentsDirectory).getChildFile("Whoosh");
+}
+
+File LibraryScanner::get_default_index_file()
+{
+	return File::getSpecialLocation(File::userApplicationDataDirectory)
+	       .getChildFile("CoSounders").getChildFile("Whoosh").getChildFile("library_index.xml");
+}
+
+//==============================================================================
+void LibraryScanner::run()
+{
+	const auto indexed_libraries = load_index();
+
+	if (! indexed_libraries.empty())
+	{
+		publish(indexed_libraries);
+	}
+
+	std::vector<Library> libraries;
+	const bool has_changed = scan(indexed_libraries, libraries);
+
+	if (has_changed && ! threadShouldExit())
+	{
+		save_index(libraries);
+		publish(std::move(libraries));
+	}
+}
+
+void LibraryScanner::handleAsyncUpdate()
+{
+	std::vector<Library> libraries;
+	{
+		const ScopedLock lock(pending_libraries_lock_);
+		std::swap(libraries, pending_libraries_);
+	}
+
+	if (on_libraries_changed != nullptr)
+	{
+		on_libraries_changed(libraries);
+	}
+}
+
+void LibraryScanner::publish(std::vector<Library> libraries)
+{
+	{
+		const ScopedLock lock(pending_libraries_lock_);
+		pending_libraries_ = std::move(libraries);
+	}
+	triggerAsyncUpdate();
+}
+
+//==============================================================================
+std::vector<LibraryScanner::Library> LibraryScanner::load_index() const
+{
+	std::vector<Library> libraries;
+
+	const auto index = XmlDocument::parse(index_file_);
+	if (index == nullptr || ! index->hasTagName("LIBRARY_INDEX"))
+	{
+		return libraries;
+	}
+
+	for (auto* library_element : index->getChildWithTagNameIterator("LIBRARY"))
+	{
+		Library library;
+		library.path = File(library_element->getStringAttribute("path"));
+		library.name = library_element->getStringAttribute("name");
+
+		for (auto* sample_element : library_element->getChildWithTagNameIterator("SAMPLE"))
+		{
+			Sample sample;
+			sample.file = File(sample_element->getStringAttribute("path"));
+			sample.modification_time = Time(sample_element->getStringAttribute("modification_time").getLargeIntValue());
+			sample.size_in_bytes = sample_element->getStringAttribute("size").getLargeIntValue();
+			sample.format_name = sample_element->getStringAttribute("format");
+			sample.length_in_samples = sample_element->getStringAttribute("length").getLargeIntValue();
+			sample.sample_rate = sample_element->getDoubleAttribute("sample_rate");
+			sample.number_of_channels = sample_element->getIntAttribute("channels");
+			library.samples.push_back(sample);
+		}
+		libraries.push_back(std::move(library));
+	}
+	return libraries;
+}
+
+void LibraryScanner::save_index(const std::vector<Library>& libraries) const
+{
+	XmlElement index("LIBRARY_INDEX");
+	index.setAttribute("version", 1);
+
+	for (const auto& library : libraries)
+	{
+		auto* library_element = index.createNewChildElement("LIBRARY");
+		library_element->setAttribute("path", library.path.getFullPathName());
+		library_element->setAttribute("name", library.name);
+
+		for (const auto& sample : library.samples)
+		{
+			auto* sample_element = library_element->createNewChildElement("SAMPLE");
+			sample_element->setAttribute("path", sample.file.getFullPathName());
+			sample_element->setAttribute("modification_time", String(sample.modification_time.toMilliseconds()));
+			sample_element->setAttribute("size", String(sample.size_in_bytes));
+			sample_element->setAttribute("format", sample.format_name);
+			sample_element->setAttribute("length", String(sample.length_in_samples));
+			sample_element->setAttribute("sample_rate", sample.sample_rate);
+			sample_element->setAttribute("channels", sample.number_of_channels);
+		}
+	}
+
+	// Written aside then swapped in, so another instance never reads half an index.
+	index_file_.getParentDirectory().createDirectory();
+	TemporaryFile temporary_file(index_file_);
+	if (index.writeTo(temporary_file.getFile()))
+	{
+		temporary_file.overwriteTargetFileWithTemporary();
+	}
+}
+
+bool LibraryScanner::scan(const std::vector<Library>& indexed_libraries, std::vector<Library>& libraries)
+{
+	std::map<String, const Sample*> indexed_samples;
+	for (const auto& library : indexed_libraries)
+	{
+		for (const auto& sample : library.samples)
+		{
+			indexed_samples[sample.file.getFullPathName()] = &sample;
+		}
+	}
+
+	bool has_changed = false;
+	size_t number_of_indexed_samples_found = 0;
+
+	auto directories = libraries_directory_.findChildFiles(File::findDirectories, false, "*");
+	directories.sort();
+
+	for (const auto& directory : directories)
+	{
+		Library library;
+		library.path = directory;
+		library.name = directory.getFileName();
+
+		// Every registered format: compressed libraries are decoded by the sample cache, off the audio thread.
+		auto files = directory.findChildFiles(File::findFiles, false, audio_format_manager_.getWildcardForAllFormats());
+		files.sort();
+
+		for (const auto& file : files)
+		{
+			if (threadShouldExit())
+			{
+				return false;
+			}
+
+			const auto indexed_sample = indexed_samples.find(file.getFullPathName());
+			const bool is_indexed = indexed_sample != indexed_samples.end();
+
+			if (is_indexed && indexed_sample->second->size_in_bytes == file.getSize()
+				&& indexed_sample->second->modification_time == file.getLastModificationTime())
+			{
+				library.samples.push_back(*indexed_sample->second);
+				++number_of_indexed_samples_found;
+				continue;
+			}
+
+			// New or modified: only now is its header read.
+			Sample sample;
+			if (read_sample(file, sample))
+			{
+				library.samples.push_back(sample);
+			}
+			has_changed = true;
+		}
+		libraries.push_back(std::move(library));
+	}
+
+	// Deleted files and libraries, or libraries added or removed, also invalidate the index.
+	const bool has_same_libraries = libraries.size() == indexed_libraries.size()
+		&& std::equal(libraries.begin(), libraries.end(), indexed_libraries.begin(),
+		              [](const Library& a, const Library& b) { return a.path == b.path; });
+
+	return has_changed || ! has_same_libraries || number_of_indexed_samples_found != indexed_samples.size();
+}
+
+bool LibraryScanner::read_sample(const File& file, Sample& sample)
+{
+	const std::unique_ptr<AudioFormatReader> reader(audio_format_manager_.createReaderFor(file));
+	if (reader == nullptr)
+	{
+		return false;
+	}
+
+	sample.file = file;
+	sample.modification_time = file.getLastModificationTime();
+	sample.size_in_bytes = file.getSize();
+	sample.format_name = reader->getFormatName();
+	sample.length_in_samples = reader->lengthInSamples;
+	sample.sample_rate = reader->sampleRate;
+	sample.number_of_channels = static_cast<int>(reader->numChannels);
+	return true;
+}
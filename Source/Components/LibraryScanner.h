@@ -0,0 +1,66 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Finds the foley libraries and their samples, in any format the format manager
+	registers, on a background thread, so plugin construction never waits on the disk.
+	Every sample's header is described in a persistent XML index; a later scan only
+	re-reads files whose size or modification time changed. The cached index is
+	published as soon as it is loaded, then again if the scan found differences.
+	Results are delivered on the message thread through on_libraries_changed.
+*/
+class LibraryScanner : private Thread,
+                       private AsyncUpdater
+{
+public:
+	struct Sample
+	{
+		File file;
+		Time modification_time;
+		int64 size_in_bytes = 0;
+		String format_name;
+		int64 length_in_samples = 0;
+		double sample_rate = 0.;
+		int number_of_channels = 0;
+	};
+
+	struct Library
+	{
+		File path;
+		String name;
+		std::vector<Sample> samples;
+	};
+
+	LibraryScanner(const File& libraries_directory, const File& index_file);
+	~LibraryScanner() override;
+
+	void start_scan();
+
+	std::function<void(const std::vector<Library>&)> on_libraries_changed;
+
+	static File get_default_libraries_directory();
+	static File get_default_index_file();
+
+private:
+	void run() override;
+	void handleAsyncUpdate() override;
+
+	void publish(std::vector<Library> libraries);
+	std::vector<Library> load_index() const;
+	void save_index(const std::vector<Library>& libraries) const;
+	bool scan(const std::vector<Library>& indexed_libraries, std::vector<Library>& libraries);
+	bool read_sample(const File& file, Sample& sample);
+	//==============================================================================
+	const File libraries_directory_;
+	const File index_file_;
+
+	AudioFormatManager audio_format_manager_;
+
+	CriticalSection pending_libraries_lock_;
+	std::vector<Library> pending_libraries_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryScanner)
+};
@@ -10,6 +10,13 @@ LibrarySelector::~LibrarySelector()
 {
 }
 
+void LibrarySelector::reload_libraries()
+{
+	element_components_.clear();
+	LibrarySelector::create_element_components();
+	resized();
+}
+
 void LibrarySelector::element_clicked(SelectorElement* selector_element_clicked)
 {
 	foley_input_->set_selected_library(selector_element_clicked->getName());
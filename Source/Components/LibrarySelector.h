@@ -25,6 +25,8 @@ public:
     ~LibrarySelector() override;
 
 	std::function<void()> on_library_loaded;
+
+	void reload_libraries();
 private:
 	void element_clicked(SelectorElement*) override ;
 	void create_element_components() override;
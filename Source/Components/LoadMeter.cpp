@@ -0,0 +1,49 @@
+#include "LoadMeter.h"
+
+LoadMeter::LoadMeter(const ProcessLoadMonitor& load_monitor): load_monitor_(load_monitor)
+{
+	setOpaque(true);
+}
+
+void LoadMeter::paint(Graphics& g)
+{
+	auto bounds = getLocalBounds();
+
+	g.fillAll(Colours::black);
+
+	const auto colour = (p99_ >= 0.8f) ? Colours::red : (p99_ >= 0.5f) ? Colours::orange : Colours::green;
+	g.setColour(colour.withAlpha(0.6f));
+	g.fillRect(bounds.withWidth(roundToInt(bounds.getWidth() * jmin(load_, 1.f))));
+
+	const int p99_x = roundToInt(bounds.getWidth() * jmin(p99_, 1.f));
+	g.setColour(colour);
+	g.drawVerticalLine(jmin(p99_x, bounds.getWidth() - 1), 0.f, static_cast<float>(bounds.getHeight()));
+
+	g.setColour(Colours::white);
+	g.setFont(Font(10));
+	g.drawText("DSP " + String(load_ * 100.f, 1) + " %  p99 " + String(p99_ * 100.f, 1) + " %",
+	           bounds.reduced(2, 0), Justification::centredLeft);
+
+	g.setColour(Colours::grey);
+	g.drawRect(bounds, 1);
+}
+
+void LoadMeter::refresh()
+{
+	if (--frames_until_update_ > 0)
+	{
+		return;
+	}
+	frames_until_update_ = frames_per_update;
+
+	const float load = load_monitor_.get_load();
+	const float p99 = load_monitor_.get_overall_statistics().p99;
+
+	// Tenths of a percent are all the text shows, so smaller moves are not worth a repaint.
+	if (std::abs(load - load_) >= 0.001f || std::abs(p99 - p99_) >= 0.001f)
+	{
+		load_ = load;
+		p99_ = p99;
+		repaint();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "ProcessLoadMonitor.h"
+#include "RefreshScheduler.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Compact DSP load bar: the smoothed overall load, with the p99 of processBlock
+	marked on top. Polls the ProcessLoadMonitor a few times per second.
+*/
+class LoadMeter : public Component,
+                  public RefreshScheduler::Client
+{
+public:
+	explicit LoadMeter(const ProcessLoadMonitor& load_monitor);
+	~LoadMeter() override = default;
+
+	void paint(Graphics& g) override;
+	void refresh() override;
+
+private:
+	enum
+	{
+		frames_per_update = 15
+	};
+
+	const ProcessLoadMonitor& load_monitor_;
+	int frames_until_update_ = 0;
+	float load_ = 0.f;
+	float p99_ = 0.f;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoadMeter)
+};
@@ -0,0 +1,119 @@
+#include "MappedSampleSource.h"
+
+MappedSampleSource::MappedSampleSource(MemoryMappedAudioFormatReader* reader, const double read_ahead_in_seconds):
+	reader_(reader),
+	length_in_samples_(reader->lengthInSamples),
+	samples_per_page_(jmax(1, static_cast<int>(page_size_in_bytes / jmax(1u, reader->numChannels * reader->bitsPerSample
+		/ 8)))),
+	read_ahead_in_seconds_(read_ahead_in_seconds)
+{
+}
+
+MappedSampleSource::~MappedSampleSource()
+{
+	read_ahead_thread_->removeTimeSliceClient(this);
+}
+
+void MappedSampleSource::prepareToPlay(int samplesPerBlockExpected, const double sampleRate)
+{
+	read_ahead_thread_->removeTimeSliceClient(this);
+
+	if (! is_mapped_.load() && length_in_samples_ > 0)
+	{
+		is_mapped_.store(reader_->mapEntireFile());
+	}
+
+	sample_rate_ = (sampleRate > 0.) ? sampleRate : 44100.;
+	play_position_.store(0);
+	prefetched_position_.store(0);
+
+	if (is_mapped_.load())
+	{
+		prefetch();
+		read_ahead_thread_->addTimeSliceClient(this);
+	}
+}
+
+void MappedSampleSource::releaseResources()
+{
+	read_ahead_thread_->removeTimeSliceClient(this);
+
+	// JUCE readers cannot unmap, so only the first page stays mapped: the pages played leave the process.
+	if (is_mapped_.exchange(false))
+	{
+		reader_->mapSectionOfFile({0, jmin<int64>(samples_per_page_, length_in_samples_)});
+	}
+}
+
+void MappedSampleSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	bufferToFill.clearActiveBufferRegion();
+
+	if (! is_mapped_.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	const int64 position = play_position_.load(std::memory_order_relaxed);
+	const int64 late_samples = position + bufferToFill.numSamples
+		- prefetched_position_.load(std::memory_order_relaxed);
+
+	if (late_samples > 0)
+	{
+		underruns_.fetch_add(1, std::memory_order_relaxed);
+		missing_samples_.fetch_add(jmin<int64>(late_samples, bufferToFill.numSamples), std::memory_order_relaxed);
+	}
+
+	for (int offset = 0; offset < bufferToFill.numSamples;)
+	{
+		const int64 position_in_file = (position + offset) % length_in_samples_;
+		const int length = static_cast<int>(jmin<int64>(bufferToFill.numSamples - offset,
+		                                                length_in_samples_ - position_in_file));
+
+		reader_->read(bufferToFill.buffer, bufferToFill.startSample + offset, length, position_in_file, true, true);
+		offset += length;
+	}
+
+	play_position_.store(position + bufferToFill.numSamples, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void MappedSampleSource::set_read_ahead_length(const double read_ahead_in_seconds)
+{
+	read_ahead_in_seconds_.store(read_ahead_in_seconds);
+}
+
+int64 MappedSampleSource::get_number_of_underruns() const noexcept
+{
+	return underruns_.load(std::memory_order_relaxed);
+}
+
+int64 MappedSampleSource::get_number_of_missing_samples() const noexcept
+{
+	return missing_samples_.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+int MappedSampleSource::useTimeSlice()
+{
+	prefetch();
+	return 5;
+}
+
+void MappedSampleSource::prefetch()
+{
+	const int64 play_position = play_position_.load(std::memory_order_relaxed);
+	const int64 end_position = play_position + jmax<int64>(
+		samples_per_page_, static_cast<int64>(read_ahead_in_seconds_.load() * sample_rate_));
+
+	// One read per page is enough for the kernel to bring the whole page in.
+	int64 position = jmax(play_position, prefetched_position_.load(std::memory_order_relaxed));
+
+	for (; position < end_position; position += samples_per_page_)
+	{
+		reader_->touchSample(position % length_in_samples_);
+	}
+	reader_->touchSample((end_position - 1) % length_in_samples_);
+
+	prefetched_position_.store(end_position, std::memory_order_relaxed);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "ISampleSource.h"
+#include "ReadAheadAudioSource.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Plays an uncompressed file straight from a memory-mapped reader, looping. Nothing
+	is decoded or buffered: the audio thread converts samples from the page cache into
+	the output block. The file is only mapped while the sample is prepared, so idle
+	samples cost a parsed header and one page. While playing, the shared read-ahead
+	thread touches the pages of the next few seconds so the audio thread does not fault
+	on them; a block that outruns that prefetch is counted as an underrun.
+*/
+class MappedSampleSource : public ISampleSource,
+                           private TimeSliceClient
+{
+public:
+	explicit MappedSampleSource(MemoryMappedAudioFormatReader* reader, double read_ahead_in_seconds = 2.);
+	~MappedSampleSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+	//==============================================================================
+	void set_read_ahead_length(double read_ahead_in_seconds) override;
+
+	int64 get_number_of_underruns() const noexcept override;
+	int64 get_number_of_missing_samples() const noexcept override;
+
+private:
+	int useTimeSlice() override;
+	void prefetch();
+
+	//==============================================================================
+	enum
+	{
+		page_size_in_bytes = 4096
+	};
+
+	std::unique_ptr<MemoryMappedAudioFormatReader> reader_;
+	const int64 length_in_samples_;
+	const int samples_per_page_;
+
+	std::atomic<bool> is_mapped_{false};
+	std::atomic<double> read_ahead_in_seconds_;
+	double sample_rate_ = 44100.;
+
+	// Both unwrapped: they keep growing across loops so they can be compared directly.
+	std::atomic<int64> play_position_{0};
+	std::atomic<int64> prefetched_position_{0};
+
+	std::atomic<int64> underruns_{0};
+	std::atomic<int64> missing_samples_{0};
+
+	SharedResourcePointer<ReadAheadAudioSource::ReadAheadThread> read_ahead_thread_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedSampleSource)
+};
@@ -3,9 +3,11 @@
 #include "Util.h"
 
 //==============================================================================
-OutParametersBox::OutParametersBox(AudioProcessorValueTreeState* output_parameters, AudioProcessorValueTreeState* internal_parameters):
+OutParametersBox::OutParametersBox(AudioProcessorValueTreeState* output_parameters, AudioProcessorValueTreeState* internal_parameters,
+                                   const ProcessLoadMonitor& load_monitor):
 	volume_out(util::Parameter(parameters::volume_out, internal_parameters)),
-	frequency_out(util::Parameter(parameters::frequency_out, internal_parameters))
+	frequency_out(util::Parameter(parameters::frequency_out, internal_parameters)),
+	load_meter_(load_monitor)
 {
 	parameters_components = {&volume_out, &frequency_out};
 	for (std::vector<parameter_gui_component*>::value_type parameters_component : parameters_components)
@@ -40,6 +42,8 @@ OutParametersBox::OutParametersBox(AudioProcessorValueTreeState* output_paramete
 	addAndMakeVisible(analyze_on_pause_button);
 	analyze_on_pause_button.setButtonText("ANALYZE ON PAUSE");
 	analyze_on_pause_button.addListener(this);
+
+	addAndMakeVisible(load_meter_);
 }
 
 OutParametersBox::~OutParametersBox()
@@ -76,6 +80,7 @@ void OutParametersBox::resized()
 	frequency_out.setBounds(sliders_rectangle.removeFromLeft(slot_width));
 
 	const int delta = 5;
+	load_meter_.setBounds(buttons_rectangle.removeFromTop(20).reduced(delta, 2));
 	show_values_button.setBounds(buttons_rectangle.removeFromBottom(30).reduced(delta));
 	analyze_on_pause_button.setBounds(buttons_rectangle.removeFromBottom(30).reduced(delta));
 }
@@ -110,6 +115,11 @@ void OutParametersBox::buttonClicked(Button* button)
 	}
 }
 
+LoadMeter& OutParametersBox::get_load_meter()
+{
+	return load_meter_;
+}
+
 void OutParametersBox::parameter_gui_component::resized()
 {
 	auto rectangle = getLocalBounds();
@@ -4,6 +4,7 @@
 
 
 #include "GuiParameter.h"
+#include "LoadMeter.h"
 #include "Util.h"
 
 using namespace juce;
@@ -16,7 +17,8 @@ class OutParametersBox : public juce::Component, private Button::Listener
 {
 public:
 
-	OutParametersBox(AudioProcessorValueTreeState* output_parameters,AudioProcessorValueTreeState* internal_parameters);
+	OutParametersBox(AudioProcessorValueTreeState* output_parameters,AudioProcessorValueTreeState* internal_parameters,
+	                 const ProcessLoadMonitor& load_monitor);
 	~OutParametersBox() override;
 
 	void paint(juce::Graphics&) override;
@@ -25,6 +27,8 @@ public:
 
 	void buttonClicked(Button*) override;
 
+	LoadMeter& get_load_meter();
+
 	struct parameter_gui_component : public ParameterGui
 	{
 		parameter_gui_component(util::Parameter parameter):
@@ -55,6 +59,8 @@ private:
 	ToggleButton show_values_button;
 	ToggleButton analyze_on_pause_button;
 
+	LoadMeter load_meter_;
+
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutParametersBox)
 };
@@ -19,5 +19,13 @@ AudioProcessorValueTreeState::ParameterLayout OutParametersState::create_paramet
 	parameters.push_back(std::make_unique<AudioParameterFloat>(parameters::frequency_out.id, parameters::frequency_out.name, frequency_range, 0.,
 	                                                           parameters::frequency_out.name, AudioProcessorParameter::genericParameter));
 
+	for (const auto& partial : parameters::partials)
+	{
+		parameters.push_back(std::make_unique<AudioParameterFloat>(partial.first.id, partial.first.name, frequency_range, 0.,
+		                                                           partial.first.name, AudioProcessorParameter::genericParameter));
+		parameters.push_back(std::make_unique<AudioParameterFloat>(partial.second.id, partial.second.name, gain_range, 0.,
+		                                                           partial.second.name, AudioProcessorParameter::genericParameter));
+	}
+
 	return {parameters.begin(), parameters.end()};
 }
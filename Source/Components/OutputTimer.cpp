@@ -2,6 +2,7 @@
 
 OutputTimer::OutputTimer(std::vector<Analyzer*>& analyzers): analyzers(analyzers)
 {
+	// Runs for the processor's whole life, editor or not: the host automates from these values.
 	startTimerHz(60);
 }
 
@@ -12,16 +13,20 @@ OutputTimer::~OutputTimer()
 
 void OutputTimer::timerCallback()
 {
-	if (internal_parameters_ != nullptr)
+	if (analyze_on_pause_ != nullptr)
 	{
-		if (is_playing_ || internal_parameters_->get_state()->getParameter(parameters::analyze_on_pause.id)->getValue())
+		if (is_playing_ || analyze_on_pause_->load(std::memory_order_relaxed) >= 0.5f)
 		{
 			for (std::vector<Analyzer*>::value_type analyzer : analyzers)
 			{
 				const float value = analyzer->get_last_value();
 				const float normalized_value = analyzer->out_parameter->convertTo0to1(value);
 
-				analyzer->out_parameter->setValueNotifyingHost(normalized_value);
+				// An unchanged value would still wake every host listener and automation writer.
+				if (normalized_value != analyzer->out_parameter->getValue())
+				{
+					analyzer->out_parameter->setValueNotifyingHost(normalized_value);
+				}
 			}
 		}
 	}
@@ -30,4 +35,5 @@ void OutputTimer::timerCallback()
 void OutputTimer::set_intern_parameters(ParametersState* interns_parameters)
 {
 	internal_parameters_ = interns_parameters;
+	analyze_on_pause_ = interns_parameters->get_state()->getRawParameterValue(parameters::analyze_on_pause.id);
 }
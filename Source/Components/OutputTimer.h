@@ -7,6 +7,12 @@
 
 using namespace juce;
 
+//==============================================================================
+/*
+	Pushes the analyzer values to the host's out parameters. It keeps its own timer
+	instead of the editor's RefreshScheduler: hosts record and follow these parameters
+	as automation with the editor closed, when that scheduler does not tick.
+*/
 class OutputTimer : juce::Timer
 {
 public:
@@ -18,7 +24,8 @@ public:
 private:
 	void timerCallback() override;
 	//===================================================================
-	ParametersState* internal_parameters_;
+	ParametersState* internal_parameters_ = nullptr;
+	std::atomic<float>* analyze_on_pause_ = nullptr;
 	std::vector<Analyzer*>& analyzers;
 
 protected:
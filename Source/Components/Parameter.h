@@ -14,7 +14,7 @@ namespace util
 
 		~Parameter();
 		//=========================================================================================================
-		parameters::AudioParameterString audio_parameter_string{"empty"};
+		parameters::AudioParameterString audio_parameter_string{"empty", "EMPTY", parameters::NUMBER_OF_PARAMETERS};
 		RangedAudioParameter* ranged_parameter = nullptr;
 
 	private:
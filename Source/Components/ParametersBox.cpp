@@ -134,11 +134,11 @@ void ParametersBox::set_parameters_value_to_text() const
 
 	frequency_variation_speed.slider->textFromValueFunction = [](double value)-> String
 	{
-		return std::to_string((int)(value * 100)) + " %";
+		return std::to_string((int) util::speed_to_time_constant_in_ms(value)) + " ms";
 	};
 	volume_variation_speed.slider->textFromValueFunction = [](double value)-> String
 	{
-		return std::to_string((int)(value * 100)) + " %";
+		return std::to_string((int) util::speed_to_time_constant_in_ms(value)) + " ms";
 	};
 }
 
@@ -0,0 +1,137 @@
+#include "ParametersSmoother.h"
+
+ParametersSmoother::ParametersSmoother(AudioProcessorValueTreeState* in_state, const double ramp_length_in_seconds):
+	ramp_length_in_seconds_(ramp_length_in_seconds)
+{
+	const RawParameters raw_parameters(in_state);
+
+	const std::array<std::pair<parameters::parameter_index, smoothing_type>, number_of_smoothed_parameters>
+		definitions{
+			{
+				{parameters::THRESHOLD, LINEAR},
+				{parameters::FREQUENCY_SPEED, LINEAR},
+				{parameters::VOLUME_SPEED, LINEAR},
+				{parameters::MIN_FREQUENCY, MULTIPLICATIVE},
+				{parameters::MAX_FREQUENCY, MULTIPLICATIVE}
+			}
+		};
+
+	slot_of_parameter_.fill(-1);
+
+	for (int slot = 0; slot < number_of_smoothed_parameters; ++slot)
+	{
+		auto& parameter = smoothed_parameters_[slot];
+		parameter.index = definitions[slot].first;
+		parameter.type = definitions[slot].second;
+		parameter.raw_value = raw_parameters.get_pointer(parameter.index);
+		jassert(parameter.raw_value != nullptr);
+
+		parameter.current = parameter.target = parameter.raw_value->load();
+		parameter.block_end_value.store(parameter.current);
+
+		slot_of_parameter_[parameter.index] = slot;
+	}
+}
+
+void ParametersSmoother::prepareToPlay(const double sampleRate, int)
+{
+	ramp_length_in_samples_ = jmax(1, roundToInt(ramp_length_in_seconds_ * sampleRate));
+
+	for (auto& parameter : smoothed_parameters_)
+	{
+		parameter.current = parameter.target = parameter.raw_value->load();
+		parameter.countdown = 0;
+		parameter.block_steps = 0;
+		parameter.block_end_value.store(parameter.current);
+	}
+}
+
+void ParametersSmoother::advance(const int number_of_samples) noexcept
+{
+	for (auto& parameter : smoothed_parameters_)
+	{
+		const float new_target = parameter.raw_value->load(std::memory_order_relaxed);
+
+		if (new_target != parameter.target)
+		{
+			set_target(parameter, new_target);
+		}
+
+		parameter.block_steps = jmin(number_of_samples, parameter.countdown);
+
+		if (parameter.block_steps > 0)
+		{
+			parameter.countdown -= parameter.block_steps;
+
+			if (parameter.countdown == 0)
+			{
+				parameter.current = parameter.target;
+			}
+			else if (parameter.type == LINEAR)
+			{
+				parameter.current += parameter.step * static_cast<float>(parameter.block_steps);
+			}
+			else
+			{
+				parameter.current *= std::pow(parameter.step, static_cast<float>(parameter.block_steps));
+			}
+		}
+		parameter.block_end_value.store(parameter.current, std::memory_order_relaxed);
+	}
+}
+
+//==============================================================================
+float ParametersSmoother::get_block_end_value(const parameters::parameter_index index) const noexcept
+{
+	const auto* parameter = find(index);
+	jassert(parameter != nullptr);
+
+	return parameter->block_end_value.load(std::memory_order_relaxed);
+}
+
+bool ParametersSmoother::is_smoothing(const parameters::parameter_index index) const noexcept
+{
+	const auto* parameter = find(index);
+	return parameter != nullptr && (parameter->countdown > 0 || parameter->block_steps > 0);
+}
+
+//==============================================================================
+void ParametersSmoother::set_target(SmoothedParameter& parameter, const float target) const noexcept
+{
+	parameter.target = target;
+
+	const bool can_ramp = ramp_length_in_samples_ > 0
+		&& (parameter.type == LINEAR || (parameter.current > 0.f && target > 0.f));
+
+	if (! can_ramp)
+	{
+		parameter.current = target;
+		parameter.countdown = 0;
+		return;
+	}
+
+	parameter.countdown = ramp_length_in_samples_;
+
+	if (parameter.type == LINEAR)
+	{
+		parameter.step = (target - parameter.current) / static_cast<float>(ramp_length_in_samples_);
+	}
+	else
+	{
+		parameter.step = std::exp((std::log(target) - std::log(parameter.current))
+			/ static_cast<float>(ramp_length_in_samples_));
+	}
+}
+
+ParametersSmoother::SmoothedParameter* ParametersSmoother::find(const parameters::parameter_index index) noexcept
+{
+	const int slot = slot_of_parameter_[index];
+	return slot < 0 ? nullptr : &smoothed_parameters_[slot];
+}
+
+const ParametersSmoother::SmoothedParameter* ParametersSmoother::find(
+	const parameters::parameter_index index) const noexcept
+{
+	const int slot = slot_of_parameter_[index];
+	return slot < 0 ? nullptr : &smoothed_parameters_[slot];
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "ParametersState.h"
+#include "AudioParametersString.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Smooths the input parameters read by the analyzers. Targets are sampled once per
+	block in advance(), which moves every ramp in O(1), so static parameters cost
+	nothing. The analyzers read them once per block or FFT frame: the block-end
+	value of the ramp is all they consume.
+*/
+class ParametersSmoother
+{
+public:
+	enum smoothing_type
+	{
+		LINEAR,
+		MULTIPLICATIVE
+	};
+
+	ParametersSmoother(AudioProcessorValueTreeState* in_state, double ramp_length_in_seconds = 0.05);
+	~ParametersSmoother() = default;
+
+	void prepareToPlay(double sampleRate, int samplesPerBlock);
+	void advance(int number_of_samples) noexcept;
+	//==============================================================================
+	float get_block_end_value(parameters::parameter_index index) const noexcept;
+	bool is_smoothing(parameters::parameter_index index) const noexcept;
+
+private:
+	struct SmoothedParameter
+	{
+		parameters::parameter_index index = parameters::NUMBER_OF_PARAMETERS;
+		smoothing_type type = LINEAR;
+		std::atomic<float>* raw_value = nullptr;
+
+		float current = 0.f;
+		float target = 0.f;
+		float step = 0.f;
+		int countdown = 0;
+		int block_steps = 0;
+
+		std::atomic<float> block_end_value{0.f};
+	};
+
+	void set_target(SmoothedParameter& parameter, float target) const noexcept;
+	SmoothedParameter* find(parameters::parameter_index index) noexcept;
+	const SmoothedParameter* find(parameters::parameter_index index) const noexcept;
+	//==============================================================================
+	enum
+	{
+		number_of_smoothed_parameters = 5
+	};
+
+	std::array<SmoothedParameter, number_of_smoothed_parameters> smoothed_parameters_;
+	std::array<int, parameters::NUMBER_OF_PARAMETERS> slot_of_parameter_{};
+
+	double ramp_length_in_seconds_;
+	int ramp_length_in_samples_ = 0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParametersSmoother)
+};
@@ -4,3 +4,23 @@ AudioProcessorValueTreeState* ParametersState::get_state() const
 {
 	return state_.get();
 }
+
+//==============================================================================
+RawParameters::RawParameters(AudioProcessorValueTreeState* state)
+{
+	for (const auto& parameter : parameters::table)
+	{
+		values_[parameter.index] = state->getRawParameterValue(parameter.id);
+	}
+}
+
+float RawParameters::get(const parameters::parameter_index index) const noexcept
+{
+	jassert(values_[index] != nullptr);
+	return values_[index]->load(std::memory_order_relaxed);
+}
+
+std::atomic<float>* RawParameters::get_pointer(const parameters::parameter_index index) const noexcept
+{
+	return values_[index];
+}
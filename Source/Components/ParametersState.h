@@ -15,3 +15,17 @@ protected:
 	virtual AudioProcessorValueTreeState::ParameterLayout create_parameters() = 0;
 	std::unique_ptr<AudioProcessorValueTreeState> state_;
 };
+
+//==============================================================================
+// Raw value pointers of a state, resolved once from parameters::table so reads are plain atomic loads.
+class RawParameters
+{
+public:
+	explicit RawParameters(AudioProcessorValueTreeState* state);
+
+	float get(parameters::parameter_index index) const noexcept;
+	std::atomic<float>* get_pointer(parameters::parameter_index index) const noexcept;
+
+private:
+	std::array<std::atomic<float>*, parameters::NUMBER_OF_PARAMETERS> values_{};
+};
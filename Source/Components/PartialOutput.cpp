@@ -0,0 +1,46 @@
+#include "PartialOutput.h"
+
+PartialOutput::PartialOutput(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state,
+                             ParametersSmoother* in_parameters_smoother, PartialTracker* partial_tracker,
+                             const int rank, const util::parameter_type type): Analyzer(
+	                                                                               out_parameter, in_state,
+	                                                                               in_parameters_smoother, type),
+                                                                               partial_tracker_(partial_tracker),
+                                                                               rank_(rank)
+{
+	jassert(type == util::PARTIAL_FREQUENCY || type == util::PARTIAL_AMPLITUDE);
+}
+
+void PartialOutput::getNextAudioBlock(AudioBuffer<float>& bufferToFill)
+{
+	// The tracker is fed by the spectrum analyzer's frames.
+}
+
+float PartialOutput::get_last_value() const
+{
+	return type == util::PARTIAL_FREQUENCY
+		       ? partial_tracker_->get_output_frequency(rank_)
+		       : partial_tracker_->get_output_amplitude(rank_);
+}
+
+void PartialOutput::set_last_value(const float value)
+{
+	if (type == util::PARTIAL_FREQUENCY)
+	{
+		partial_tracker_->set_output_frequency(rank_, value);
+	}
+	else
+	{
+		partial_tracker_->set_output_amplitude(rank_, value);
+	}
+}
+
+String PartialOutput::get_name() const
+{
+	return "Partial " + String(rank_ + 1) + (type == util::PARTIAL_FREQUENCY ? " frequency" : " amplitude");
+}
+
+String PartialOutput::get_osc_address() const
+{
+	return "/partial/" + String(rank_ + 1) + (type == util::PARTIAL_FREQUENCY ? "/frequency" : "/amplitude");
+}
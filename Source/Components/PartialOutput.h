@@ -0,0 +1,28 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "Analyzer.h"
+#include "PartialTracker.h"
+
+using namespace juce;
+
+// Exposes one rank of a PartialTracker as an analyzer, so OutputTimer and the analysis bus treat it
+// like the others: a follower's tracker is skipped and its outputs are set from the publisher's.
+class PartialOutput : public Analyzer
+{
+public:
+	PartialOutput(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state,
+	              ParametersSmoother* in_parameters_smoother, PartialTracker* partial_tracker, int rank,
+	              util::parameter_type type);
+
+	void getNextAudioBlock(AudioBuffer<float>& bufferToFill) override;
+	String get_name() const override;
+	//=================================================================================================
+	float get_last_value() const override;
+	void set_last_value(float value) override;
+	String get_osc_address() const override;
+
+private:
+	PartialTracker* partial_tracker_;
+	int rank_;
+};
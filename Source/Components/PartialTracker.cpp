@@ -0,0 +1,280 @@
+#include "PartialTracker.h"
+
+PartialTracker::PartialTracker()
+{
+	reset();
+}
+
+void PartialTracker::prepare(const double frequency_interval, const float amplitude_scale)
+{
+	frequency_interval_ = frequency_interval;
+	amplitude_scale_ = amplitude_scale;
+	reset();
+}
+
+void PartialTracker::reset() noexcept
+{
+	number_of_peaks_ = 0;
+
+	for (auto& track : tracks_)
+	{
+		track = Partial();
+	}
+	for (int rank = 0; rank < number_of_outputs; ++rank)
+	{
+		output_frequencies_[rank].store(0.f);
+		output_amplitudes_[rank].store(0.f);
+	}
+}
+
+void PartialTracker::process_frame(const float* magnitudes, const int min_bin, const int max_bin,
+                                   const float threshold) noexcept
+{
+	pick_peaks(magnitudes, min_bin, max_bin, threshold);
+	match_peaks();
+	start_tracks();
+	publish_outputs();
+}
+
+//==============================================================================
+float PartialTracker::get_output_frequency(const int rank) const noexcept
+{
+	jassert(isPositiveAndBelow(rank, static_cast<int>(number_of_outputs)));
+	return output_frequencies_[rank].load(std::memory_order_relaxed);
+}
+
+float PartialTracker::get_output_amplitude(const int rank) const noexcept
+{
+	jassert(isPositiveAndBelow(rank, static_cast<int>(number_of_outputs)));
+	return output_amplitudes_[rank].load(std::memory_order_relaxed);
+}
+
+void PartialTracker::set_output_frequency(const int rank, const float frequency) noexcept
+{
+	jassert(isPositiveAndBelow(rank, static_cast<int>(number_of_outputs)));
+	output_frequencies_[rank].store(frequency, std::memory_order_relaxed);
+}
+
+void PartialTracker::set_output_amplitude(const int rank, const float amplitude) noexcept
+{
+	jassert(isPositiveAndBelow(rank, static_cast<int>(number_of_outputs)));
+	output_amplitudes_[rank].store(amplitude, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void PartialTracker::pick_peaks(const float* magnitudes, const int min_bin, const int max_bin,
+                                const float threshold) noexcept
+{
+	// Min-heap on amplitude: the weakest kept peak sits at the front and is the one evicted.
+	const auto is_stronger = [](const Peak& a, const Peak& b) { return a.amplitude > b.amplitude; };
+
+	number_of_peaks_ = 0;
+
+	for (int bin = jmax(1, min_bin); bin < max_bin; ++bin)
+	{
+		const float magnitude = magnitudes[bin];
+
+		if (magnitude < threshold || magnitude <= magnitudes[bin - 1] || magnitude < magnitudes[bin + 1])
+		{
+			continue;
+		}
+
+		// Parabolic interpolation around the local maximum refines the bin position.
+		const float left = magnitudes[bin - 1];
+		const float right = magnitudes[bin + 1];
+		const float denominator = left - 2.f * magnitude + right;
+		const float offset = (denominator != 0.f) ? 0.5f * (left - right) / denominator : 0.f;
+
+		Peak peak;
+		peak.frequency = static_cast<float>((bin + offset) * frequency_interval_);
+		peak.amplitude = (magnitude - 0.25f * (left - right) * offset) * amplitude_scale_;
+
+		if (number_of_peaks_ < max_peaks)
+		{
+			peaks_[number_of_peaks_++] = peak;
+			std::push_heap(peaks_.begin(), peaks_.begin() + number_of_peaks_, is_stronger);
+		}
+		else if (peak.amplitude > peaks_.front().amplitude)
+		{
+			std::pop_heap(peaks_.begin(), peaks_.end(), is_stronger);
+			peaks_.back() = peak;
+			std::push_heap(peaks_.begin(), peaks_.end(), is_stronger);
+		}
+	}
+}
+
+void PartialTracker::match_peaks() noexcept
+{
+	int number_of_matches = 0;
+
+	// Each live track proposes its two nearest peaks; pairs are then granted closest first.
+	for (int track_index = 0; track_index < max_tracks; ++track_index)
+	{
+		is_track_matched_[track_index] = false;
+
+		const auto& track = tracks_[track_index];
+		if (! track.is_active)
+		{
+			continue;
+		}
+
+		const float max_deviation = track.frequency * max_relative_deviation_;
+		Match nearest{max_deviation, track_index, -1};
+		Match second{max_deviation, track_index, -1};
+
+		for (int peak_index = 0; peak_index < number_of_peaks_; ++peak_index)
+		{
+			const float distance = std::abs(peaks_[peak_index].frequency - track.frequency);
+
+			if (distance < nearest.distance)
+			{
+				second = nearest;
+				nearest = {distance, track_index, peak_index};
+			}
+			else if (distance < second.distance)
+			{
+				second = {distance, track_index, peak_index};
+			}
+		}
+
+		if (nearest.peak >= 0)
+		{
+			matches_[number_of_matches++] = nearest;
+		}
+		if (second.peak >= 0)
+		{
+			matches_[number_of_matches++] = second;
+		}
+	}
+
+	std::sort(matches_.begin(), matches_.begin() + number_of_matches,
+	          [](const Match& a, const Match& b) { return a.distance < b.distance; });
+
+	for (int peak_index = 0; peak_index < number_of_peaks_; ++peak_index)
+	{
+		peaks_[peak_index].is_claimed = false;
+	}
+
+	for (int index = 0; index < number_of_matches; ++index)
+	{
+		const auto& match = matches_[index];
+		auto& peak = peaks_[match.peak];
+
+		if (is_track_matched_[match.track] || peak.is_claimed)
+		{
+			continue;
+		}
+
+		auto& track = tracks_[match.track];
+		track.frequency = peak.frequency;
+		track.amplitude = peak.amplitude;
+		track.missed_frames = 0;
+
+		is_track_matched_[match.track] = true;
+		peak.is_claimed = true;
+	}
+
+	// Unmatched tracks fade for a few frames before dying, which bridges short dropouts.
+	for (int track_index = 0; track_index < max_tracks; ++track_index)
+	{
+		auto& track = tracks_[track_index];
+
+		if (track.is_active && ! is_track_matched_[track_index])
+		{
+			track.amplitude *= 0.5f;
+
+			if (++track.missed_frames > max_missed_frames)
+			{
+				track = Partial();
+			}
+		}
+	}
+}
+
+void PartialTracker::start_tracks() noexcept
+{
+	// Strongest first, so when the tracks run out the peaks left without one are the weakest.
+	std::sort(peaks_.begin(), peaks_.begin() + number_of_peaks_,
+	          [](const Peak& a, const Peak& b) { return a.amplitude > b.amplitude; });
+
+	for (int peak_index = 0; peak_index < number_of_peaks_; ++peak_index)
+	{
+		const auto& peak = peaks_[peak_index];
+		if (peak.is_claimed)
+		{
+			continue;
+		}
+
+		const int track_index = find_free_track();
+		if (track_index < 0)
+		{
+			return;
+		}
+
+		// Every remaining peak is weaker still than the weakest track it could evict.
+		auto& track = tracks_[track_index];
+		if (track.is_active && track.amplitude >= peak.amplitude)
+		{
+			return;
+		}
+
+		track.frequency = peak.frequency;
+		track.amplitude = peak.amplitude;
+		track.missed_frames = 0;
+		track.is_active = true;
+		is_track_matched_[track_index] = true;
+	}
+}
+
+int PartialTracker::find_free_track() const noexcept
+{
+	// A free slot if there is one, else the weakest track that was not continued this frame.
+	int weakest = -1;
+
+	for (int track_index = 0; track_index < max_tracks; ++track_index)
+	{
+		const auto& track = tracks_[track_index];
+
+		if (! track.is_active)
+		{
+			return track_index;
+		}
+		if (! is_track_matched_[track_index] && (weakest < 0 || track.amplitude < tracks_[weakest].amplitude))
+		{
+			weakest = track_index;
+		}
+	}
+	return weakest;
+}
+
+void PartialTracker::publish_outputs() noexcept
+{
+	for (int track_index = 0; track_index < max_tracks; ++track_index)
+	{
+		ranking_[track_index] = track_index;
+	}
+
+	std::partial_sort(ranking_.begin(), ranking_.begin() + number_of_outputs, ranking_.end(),
+	                  [this](const int a, const int b)
+	                  {
+		                  const float amplitude_a = tracks_[a].is_active ? tracks_[a].amplitude : -1.f;
+		                  const float amplitude_b = tracks_[b].is_active ? tracks_[b].amplitude : -1.f;
+		                  return amplitude_a > amplitude_b;
+	                  });
+
+	for (int rank = 0; rank < number_of_outputs; ++rank)
+	{
+		const auto& track = tracks_[ranking_[rank]];
+
+		// An empty rank keeps its last frequency so the host sees the amplitude fall, not a pitch jump.
+		if (track.is_active)
+		{
+			set_output_frequency(rank, track.frequency);
+			set_output_amplitude(rank, track.amplitude);
+		}
+		else
+		{
+			set_output_amplitude(rank, 0.f);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Follows the few strongest spectral peaks from frame to frame, McAulay-Quatieri
+	style. Peaks are picked with a bounded heap, matched to the previous frame's
+	tracks by nearest frequency, and the strongest tracks are published as outputs.
+	Every buffer is preallocated, so process_frame() is safe on the audio thread.
+*/
+class PartialTracker
+{
+public:
+	enum
+	{
+		max_peaks = 32,
+		max_tracks = 16,
+		number_of_outputs = 3,
+		max_missed_frames = 3
+	};
+
+	struct Partial
+	{
+		float frequency = 0.f;
+		float amplitude = 0.f;
+		int missed_frames = 0;
+		bool is_active = false;
+	};
+
+	PartialTracker();
+	~PartialTracker() = default;
+
+	void prepare(double frequency_interval, float amplitude_scale);
+	void reset() noexcept;
+	void process_frame(const float* magnitudes, int min_bin, int max_bin, float threshold) noexcept;
+
+	//==============================================================================
+	float get_output_frequency(int rank) const noexcept;
+	float get_output_amplitude(int rank) const noexcept;
+	void set_output_frequency(int rank, float frequency) noexcept;
+	void set_output_amplitude(int rank, float amplitude) noexcept;
+
+private:
+	struct Peak
+	{
+		float frequency = 0.f;
+		float amplitude = 0.f;
+		bool is_claimed = false;
+	};
+
+	struct Match
+	{
+		float distance = 0.f;
+		int track = 0;
+		int peak = 0;
+	};
+
+	void pick_peaks(const float* magnitudes, int min_bin, int max_bin, float threshold) noexcept;
+	void match_peaks() noexcept;
+	void start_tracks() noexcept;
+	void publish_outputs() noexcept;
+	int find_free_track() const noexcept;
+	//==============================================================================
+	double frequency_interval_ = 0.;
+	float amplitude_scale_ = 1.f;
+	float max_relative_deviation_ = 0.06f;
+
+	std::array<Peak, max_peaks> peaks_;
+	int number_of_peaks_ = 0;
+
+	std::array<Partial, max_tracks> tracks_;
+	std::array<bool, max_tracks> is_track_matched_{};
+	std::array<Match, 2 * max_tracks> matches_;
+	std::array<int, max_tracks> ranking_{};
+
+	std::array<std::atomic<float>, number_of_outputs> output_frequencies_;
+	std::array<std::atomic<float>, number_of_outputs> output_amplitudes_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartialTracker)
+};
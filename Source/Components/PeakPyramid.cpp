@@ -0,0 +1,170 @@
+#include "PeakPyramid.h"
+
+void PeakPyramid::prepare(const int number_of_channels, const int capacity)
+{
+	jassert(capacity % largest_bucket_size == 0);
+
+	number_of_channels_ = number_of_channels;
+
+	for (int level_index = 0; level_index < number_of_levels; ++level_index)
+	{
+		auto& level = levels_[level_index];
+		level.bucket_size = get_bucket_size(level_index);
+		level.number_of_buckets = jmax(1, capacity / level.bucket_size);
+		level.mask = level.number_of_buckets - 1;
+		level.buckets.calloc(static_cast<size_t>(number_of_channels) * level.number_of_buckets);
+	}
+}
+
+void PeakPyramid::add_samples(const float* const* ring_channels, const int ring_mask, int64 position,
+                              const int number_of_samples) noexcept
+{
+	const int64 end_position = position + number_of_samples;
+
+	// Chunks never straddle a base bucket, so they never straddle the end of the ring either.
+	while (position < end_position)
+	{
+		const int offset_in_bucket = static_cast<int>(position % base_bucket_size);
+		const int length = static_cast<int>(jmin<int64>(base_bucket_size - offset_in_bucket,
+		                                                end_position - position));
+		const int ring_index = static_cast<int>(position & ring_mask);
+
+		for (int channel = 0; channel < number_of_channels_; ++channel)
+		{
+			const float* samples = ring_channels[channel] + ring_index;
+			const auto range = FloatVectorOperations::findMinAndMax(samples, length);
+
+			float sum_of_squares = 0.f;
+			for (int sample = 0; sample < length; ++sample)
+			{
+				sum_of_squares += samples[sample] * samples[sample];
+			}
+
+			const Bucket chunk{range.getStart(), range.getEnd(), sum_of_squares};
+
+			for (int level = 0; level < number_of_levels; ++level)
+			{
+				auto& bucket = get_bucket(level, channel, position);
+
+				if (position % levels_[level].bucket_size == 0)
+				{
+					bucket = chunk;
+				}
+				else
+				{
+					merge(bucket, chunk);
+				}
+			}
+		}
+		position += length;
+	}
+}
+
+void PeakPyramid::read_columns(const int channel, const int64 start_position, const int64 end_position,
+                               Column* columns, const int number_of_columns, const float* ring_channel,
+                               const int ring_mask, const int64 oldest_position, const int64 write_position) const
+{
+	jassert(isPositiveAndBelow(channel, number_of_channels_));
+
+	const double samples_per_column = static_cast<double>(end_position - start_position) / number_of_columns;
+
+	// The coarsest level that still fits in a column; none means plain samples are cheaper.
+	int level = -1;
+	for (int level_index = number_of_levels - 1; level_index >= 0; --level_index)
+	{
+		if (get_bucket_size(level_index) <= samples_per_column)
+		{
+			level = level_index;
+			break;
+		}
+	}
+
+	const int bucket_size = (level >= 0) ? levels_[level].bucket_size : 1;
+
+	// A bucket only partly inside the ring shares its slot with the newest one, so it is skipped.
+	const int64 first_valid_position = ((oldest_position + bucket_size - 1) / bucket_size) * bucket_size;
+
+	for (int column_index = 0; column_index < number_of_columns; ++column_index)
+	{
+		auto& column = columns[column_index];
+		column = Column();
+
+		const auto column_start = jmax(first_valid_position,
+		                               start_position + static_cast<int64>(column_index * samples_per_column));
+		const auto column_end = jmin(write_position,
+		                             jmax(column_start + 1,
+		                                  start_position + static_cast<int64>((column_index + 1) *
+			                                  samples_per_column)));
+
+		if (column_end <= column_start)
+		{
+			continue;
+		}
+
+		Bucket total;
+		int64 number_of_samples = 0;
+
+		if (level < 0)
+		{
+			total.min = total.max = ring_channel[column_start & ring_mask];
+
+			for (auto position = column_start; position < column_end; ++position)
+			{
+				const float sample = ring_channel[position & ring_mask];
+				merge(total, {sample, sample, sample * sample});
+			}
+			number_of_samples = column_end - column_start;
+		}
+		else
+		{
+			const int64 first_bucket_start = (column_start / bucket_size) * bucket_size;
+
+			total = get_bucket(level, channel, first_bucket_start);
+
+			for (auto position = first_bucket_start + bucket_size; position < column_end; position += bucket_size)
+			{
+				merge(total, get_bucket(level, channel, position));
+			}
+
+			const int64 last_bucket_end = ((column_end + bucket_size - 1) / bucket_size) * bucket_size;
+			number_of_samples = jmin(last_bucket_end, write_position) - first_bucket_start;
+		}
+
+		column.min = total.min;
+		column.max = total.max;
+		column.rms = std::sqrt(total.sum_of_squares / static_cast<float>(jmax<int64>(1, number_of_samples)));
+	}
+}
+
+int PeakPyramid::get_bucket_size(const int level) noexcept
+{
+	int bucket_size = base_bucket_size;
+	for (int index = 0; index < level; ++index)
+	{
+		bucket_size *= level_ratio;
+	}
+	return bucket_size;
+}
+
+//==============================================================================
+void PeakPyramid::merge(Bucket& bucket, const Bucket& other) noexcept
+{
+	bucket.min = jmin(bucket.min, other.min);
+	bucket.max = jmax(bucket.max, other.max);
+	bucket.sum_of_squares += other.sum_of_squares;
+}
+
+PeakPyramid::Bucket& PeakPyramid::get_bucket(const int level, const int channel, const int64 position) noexcept
+{
+	const auto& pyramid_level = levels_[level];
+	const auto index = static_cast<int>((position / pyramid_level.bucket_size) & pyramid_level.mask);
+	return pyramid_level.buckets[static_cast<size_t>(channel) * pyramid_level.number_of_buckets + index];
+}
+
+const PeakPyramid::Bucket& PeakPyramid::get_bucket(const int level, const int channel,
+                                                   const int64 position) const noexcept
+{
+	const auto& pyramid_level = levels_[level];
+	const auto index = static_cast<int>((position / pyramid_level.bucket_size) & pyramid_level.mask);
+	return pyramid_level.buckets[static_cast<size_t>(channel) * pyramid_level.number_of_buckets + index];
+}
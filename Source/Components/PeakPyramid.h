@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/*
+	Min / max / RMS summaries of a RecordingBuffer's ring at 64, 512 and 4096 samples
+	per bucket. Each level is a ring of buckets covering the same span as the audio,
+	updated incrementally as blocks arrive: the bucket being filled is always up to
+	date, so readers never wait for it to complete. A column of any width is built
+	from at most eight buckets of the best fitting level, which makes drawing cost
+	proportional to the number of pixels, not to the recorded length.
+*/
+class PeakPyramid
+{
+public:
+	enum
+	{
+		number_of_levels = 3,
+		base_bucket_size = 64,
+		level_ratio = 8,
+		largest_bucket_size = base_bucket_size * level_ratio * level_ratio
+	};
+
+	struct Column
+	{
+		float min = 0.f;
+		float max = 0.f;
+		float rms = 0.f;
+	};
+
+	PeakPyramid() = default;
+
+	void prepare(int number_of_channels, int capacity);
+	void add_samples(const float* const* ring_channels, int ring_mask, int64 position, int number_of_samples) noexcept;
+
+	void read_columns(int channel, int64 start_position, int64 end_position, Column* columns, int number_of_columns,
+	                  const float* ring_channel, int ring_mask, int64 oldest_position, int64 write_position) const;
+
+	static int get_bucket_size(int level) noexcept;
+
+private:
+	struct Bucket
+	{
+		float min = 0.f;
+		float max = 0.f;
+		float sum_of_squares = 0.f;
+	};
+
+	struct Level
+	{
+		HeapBlock<Bucket> buckets;
+		int bucket_size = 0;
+		int number_of_buckets = 0;
+		int mask = 0;
+	};
+
+	static void merge(Bucket& bucket, const Bucket& other) noexcept;
+	Bucket& get_bucket(int level, int channel, int64 position) noexcept;
+	const Bucket& get_bucket(int level, int channel, int64 position) const noexcept;
+	//==============================================================================
+	std::array<Level, number_of_levels> levels_;
+	int number_of_channels_ = 0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PeakPyramid)
+};
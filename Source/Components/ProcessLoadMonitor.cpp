@@ -0,0 +1,206 @@
+#include "ProcessLoadMonitor.h"
+
+ProcessLoadMonitor::ProcessLoadMonitor()
+{
+	reset_statistics();
+}
+
+void ProcessLoadMonitor::prepare(const double sample_rate)
+{
+	sample_rate_.store(sample_rate);
+	reset_statistics();
+}
+
+void ProcessLoadMonitor::add_element(const AudioChainElement* element)
+{
+	const ScopedLock lock(names_lock_);
+
+	const int number_of_slots = number_of_slots_.load();
+
+	for (int index = 0; index < number_of_slots; ++index)
+	{
+		if (slots_[index].element.load() == element)
+		{
+			return;
+		}
+	}
+
+	// Past max_elements, new elements still run, they are just not timed.
+	if (number_of_slots == max_elements)
+	{
+		return;
+	}
+
+	auto& slot = slots_[number_of_slots];
+	slot.name = element->get_name();
+	slot.histogram.reset();
+	slot.element.store(element);
+	number_of_slots_.store(number_of_slots + 1, std::memory_order_release);
+}
+
+void ProcessLoadMonitor::process(AudioChainElement* element, AudioBuffer<float>& buffer) noexcept
+{
+	const auto start_ticks = Time::getHighResolutionTicks();
+	element->getNextAudioBlock(buffer);
+	const auto end_ticks = Time::getHighResolutionTicks();
+
+	const int number_of_slots = number_of_slots_.load(std::memory_order_acquire);
+
+	for (int index = 0; index < number_of_slots; ++index)
+	{
+		auto& slot = slots_[index];
+
+		if (slot.element.load(std::memory_order_relaxed) == element)
+		{
+			const double seconds = Time::highResolutionTicksToSeconds(end_ticks - start_ticks);
+			slot.histogram.add(get_block_fraction(buffer.getNumSamples(), seconds));
+			return;
+		}
+	}
+}
+
+//==============================================================================
+float ProcessLoadMonitor::get_load() const noexcept
+{
+	return load_.load(std::memory_order_relaxed);
+}
+
+ProcessLoadMonitor::Statistics ProcessLoadMonitor::get_overall_statistics() const
+{
+	auto statistics = overall_.get_statistics();
+	statistics.name = "Overall";
+	return statistics;
+}
+
+std::vector<ProcessLoadMonitor::Statistics> ProcessLoadMonitor::get_element_statistics() const
+{
+	const ScopedLock lock(names_lock_);
+
+	std::vector<Statistics> element_statistics;
+	const int number_of_slots = number_of_slots_.load(std::memory_order_acquire);
+
+	for (int index = 0; index < number_of_slots; ++index)
+	{
+		auto statistics = slots_[index].histogram.get_statistics();
+		statistics.name = slots_[index].name;
+		element_statistics.push_back(statistics);
+	}
+	return element_statistics;
+}
+
+void ProcessLoadMonitor::reset_statistics() noexcept
+{
+	// A block recorded concurrently may survive the reset; the histograms are only a trend.
+	overall_.reset();
+	load_.store(0.f);
+
+	for (auto& slot : slots_)
+	{
+		slot.histogram.reset();
+	}
+}
+
+//==============================================================================
+ProcessLoadMonitor::ScopedBlock::ScopedBlock(ProcessLoadMonitor& monitor, const int number_of_samples) noexcept:
+	monitor_(monitor), start_ticks_(Time::getHighResolutionTicks()), number_of_samples_(number_of_samples)
+{
+}
+
+ProcessLoadMonitor::ScopedBlock::~ScopedBlock()
+{
+	const auto end_ticks = Time::getHighResolutionTicks();
+	monitor_.add_block(number_of_samples_, Time::highResolutionTicksToSeconds(end_ticks - start_ticks_));
+}
+
+//==============================================================================
+void ProcessLoadMonitor::add_block(const int number_of_samples, const double seconds) noexcept
+{
+	const float fraction = get_block_fraction(number_of_samples, seconds);
+
+	if (number_of_samples > 0)
+	{
+		overall_.add(fraction);
+
+		// Same one-pole smoothing as AudioProcessLoadMeasurer.
+		const float load = load_.load(std::memory_order_relaxed);
+		load_.store(load + 0.2f * (jmin(fraction, 1.f) - load), std::memory_order_relaxed);
+	}
+}
+
+float ProcessLoadMonitor::get_block_fraction(const int number_of_samples, const double seconds) const noexcept
+{
+	const double sample_rate = sample_rate_.load(std::memory_order_relaxed);
+
+	if (number_of_samples <= 0 || sample_rate <= 0.)
+	{
+		return 0.f;
+	}
+	return static_cast<float>(seconds * sample_rate / number_of_samples);
+}
+
+void ProcessLoadMonitor::Histogram::add(const float fraction) noexcept
+{
+	const float octave = std::log2(jmax(fraction, std::numeric_limits<float>::min()));
+	const int bin = jlimit(0, static_cast<int>(number_of_bins) - 1,
+	                       static_cast<int>((octave - lowest_octave) * bins_per_octave));
+
+	bins[bin].fetch_add(1, std::memory_order_relaxed);
+
+	float previous_max = max.load(std::memory_order_relaxed);
+	while (fraction > previous_max
+		&& ! max.compare_exchange_weak(previous_max, fraction, std::memory_order_relaxed))
+	{
+	}
+}
+
+ProcessLoadMonitor::Statistics ProcessLoadMonitor::Histogram::get_statistics() const
+{
+	std::array<uint32, number_of_bins> counts;
+	int64 total = 0;
+
+	for (int bin = 0; bin < number_of_bins; ++bin)
+	{
+		counts[bin] = bins[bin].load(std::memory_order_relaxed);
+		total += counts[bin];
+	}
+
+	Statistics statistics;
+	statistics.number_of_blocks = total;
+	statistics.max = max.load(std::memory_order_relaxed);
+
+	if (total == 0)
+	{
+		return statistics;
+	}
+
+	// A percentile is reported as the upper edge of its bin, about 4 % above the true value.
+	const auto get_percentile = [&](const double proportion)
+	{
+		const auto rank = static_cast<int64>(std::ceil(proportion * total));
+		int64 count = 0;
+
+		for (int bin = 0; bin < number_of_bins; ++bin)
+		{
+			count += counts[bin];
+			if (count >= rank)
+			{
+				const float upper_edge = std::exp2(lowest_octave + (bin + 1) / static_cast<float>(bins_per_octave));
+				return jmin(upper_edge, statistics.max);
+			}
+		}
+		return statistics.max;
+	};
+
+	statistics.p50 = get_percentile(0.5);
+	statistics.p99 = get_percentile(0.99);
+	return statistics;
+}
+
+void ProcessLoadMonitor::Histogram::reset() noexcept
+{
+	for (auto& bin : bins)
+	{
+		bin.store(0, std::memory_order_relaxed);
+	}
+	max.store(0.f, std::memory_order_relaxed);
+}
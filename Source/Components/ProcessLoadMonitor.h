@@ -0,0 +1,98 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "AudioChainElement.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Times processBlock and every AudioChainElement it runs, as a fraction of the block
+	duration. Each measure lands in a lock-free log-spaced histogram (16 bins per
+	octave), so p50, p99 and max can be read from any thread while the audio thread
+	keeps writing. Elements are registered from prepareToPlay(); the audio thread only
+	looks them up. The overall figure is a smoothed load like AudioProcessLoadMeasurer's.
+*/
+class ProcessLoadMonitor
+{
+public:
+	enum
+	{
+		max_elements = 16,
+		number_of_bins = 256,
+		bins_per_octave = 16,
+		lowest_octave = -14
+	};
+
+	struct Statistics
+	{
+		String name;
+		float p50 = 0.f;
+		float p99 = 0.f;
+		float max = 0.f;
+		int64 number_of_blocks = 0;
+	};
+
+	//==============================================================================
+	class ScopedBlock
+	{
+	public:
+		ScopedBlock(ProcessLoadMonitor& monitor, int number_of_samples) noexcept;
+		~ScopedBlock();
+
+	private:
+		ProcessLoadMonitor& monitor_;
+		const int64 start_ticks_;
+		const int number_of_samples_;
+	};
+
+	//==============================================================================
+	ProcessLoadMonitor();
+	~ProcessLoadMonitor() = default;
+
+	void prepare(double sample_rate);
+	void add_element(const AudioChainElement* element);
+
+	// Runs the element and records how long it took.
+	void process(AudioChainElement* element, AudioBuffer<float>& buffer) noexcept;
+
+	//==============================================================================
+	float get_load() const noexcept;
+	Statistics get_overall_statistics() const;
+	std::vector<Statistics> get_element_statistics() const;
+	void reset_statistics() noexcept;
+
+private:
+	struct Histogram
+	{
+		std::array<std::atomic<uint32>, number_of_bins> bins;
+		std::atomic<float> max{0.f};
+
+		void add(float fraction) noexcept;
+		Statistics get_statistics() const;
+		void reset() noexcept;
+	};
+
+	struct Slot
+	{
+		std::atomic<const AudioChainElement*> element{nullptr};
+		String name;
+		Histogram histogram;
+	};
+
+	void add_block(int number_of_samples, double seconds) noexcept;
+	float get_block_fraction(int number_of_samples, double seconds) const noexcept;
+	//==============================================================================
+	std::atomic<double> sample_rate_{0.};
+
+	Histogram overall_;
+	std::atomic<float> load_{0.f};
+
+	std::array<Slot, max_elements> slots_;
+	std::atomic<int> number_of_slots_{0};
+
+	// Serialises registration and name reads; never taken on the audio thread.
+	CriticalSection names_lock_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessLoadMonitor)
+};
@@ -0,0 +1,165 @@
+#include "ReadAheadAudioSource.h"
+
+ReadAheadAudioSource::ReadAheadThread::ReadAheadThread(): TimeSliceThread("Foley read-ahead")
+{
+	startThread(6);
+}
+
+ReadAheadAudioSource::ReadAheadThread::~ReadAheadThread()
+{
+	stopThread(1000);
+}
+
+//==============================================================================
+ReadAheadAudioSource::ReadAheadAudioSource(PositionableAudioSource* source, const bool delete_source_when_deleted,
+                                           const int number_of_channels, const double read_ahead_in_seconds):
+	source_(source, delete_source_when_deleted),
+	number_of_channels_(jmax(1, number_of_channels)),
+	read_ahead_in_seconds_(read_ahead_in_seconds)
+{
+}
+
+ReadAheadAudioSource::~ReadAheadAudioSource()
+{
+	releaseResources();
+}
+
+void ReadAheadAudioSource::prepareToPlay(const int samplesPerBlockExpected, const double sampleRate)
+{
+	read_ahead_thread_->removeTimeSliceClient(this);
+
+	{
+		const ScopedLock lock(source_lock_);
+
+		// An unknown rate still gets a usable FIFO; it is resized on the next prepare.
+		const double sample_rate = (sampleRate > 0.) ? sampleRate : 44100.;
+		const int size = jmax(4 * jmax(samplesPerBlockExpected, static_cast<int>(chunk_size)),
+		                      roundToInt(read_ahead_in_seconds_ * sample_rate));
+
+		buffer_.setSize(number_of_channels_, size);
+		fifo_.setTotalSize(size);
+		fifo_.reset();
+
+		source_->prepareToPlay(samplesPerBlockExpected, sample_rate);
+		source_->setNextReadPosition(0);
+
+		// Only the first blocks are read here, so selecting a sample on a slow disk does not stall the
+		// message thread for the whole read-ahead length; the read-ahead thread fills the rest.
+		const int prefill_length = jmin(fifo_.getTotalSize() - 1,
+		                                prefill_blocks * jmax(samplesPerBlockExpected, static_cast<int>(chunk_size)));
+		for (int number_of_samples_read = 0; number_of_samples_read < prefill_length;)
+		{
+			const int length = read_ahead(prefill_length - number_of_samples_read);
+			if (length == 0)
+			{
+				break;
+			}
+			number_of_samples_read += length;
+		}
+		is_prepared_ = true;
+	}
+
+	read_ahead_thread_->addTimeSliceClient(this);
+}
+
+void ReadAheadAudioSource::releaseResources()
+{
+	read_ahead_thread_->removeTimeSliceClient(this);
+
+	const ScopedLock lock(source_lock_);
+
+	// The FIFO goes too: it holds seconds of audio, and prepareToPlay() allocates it again.
+	if (is_prepared_)
+	{
+		source_->releaseResources();
+		fifo_.setTotalSize(1);
+		buffer_.setSize(0, 0);
+		is_prepared_ = false;
+	}
+}
+
+void ReadAheadAudioSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	int start1, size1, start2, size2;
+	fifo_.prepareToRead(bufferToFill.numSamples, start1, size1, start2, size2);
+
+	const int number_of_samples_read = size1 + size2;
+
+	for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+	{
+		const int source_channel = jmin(channel, number_of_channels_ - 1);
+
+		if (size1 > 0)
+		{
+			bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample, buffer_, source_channel, start1, size1);
+		}
+		if (size2 > 0)
+		{
+			bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample + size1, buffer_, source_channel, start2,
+			                              size2);
+		}
+	}
+	fifo_.finishedRead(number_of_samples_read);
+
+	if (number_of_samples_read < bufferToFill.numSamples)
+	{
+		bufferToFill.buffer->clear(bufferToFill.startSample + number_of_samples_read,
+		                           bufferToFill.numSamples - number_of_samples_read);
+
+		underruns_.fetch_add(1, std::memory_order_relaxed);
+		missing_samples_.fetch_add(bufferToFill.numSamples - number_of_samples_read, std::memory_order_relaxed);
+	}
+}
+
+//==============================================================================
+void ReadAheadAudioSource::set_read_ahead_length(const double read_ahead_in_seconds)
+{
+	read_ahead_in_seconds_ = read_ahead_in_seconds;
+}
+
+int64 ReadAheadAudioSource::get_number_of_underruns() const noexcept
+{
+	return underruns_.load(std::memory_order_relaxed);
+}
+
+int64 ReadAheadAudioSource::get_number_of_missing_samples() const noexcept
+{
+	return missing_samples_.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+int ReadAheadAudioSource::useTimeSlice()
+{
+	const ScopedLock lock(source_lock_);
+
+	if (! is_prepared_)
+	{
+		return 500;
+	}
+
+	// Idle until at least a chunk has been played, so reads stay large.
+	return (read_ahead(chunk_size) > 0) ? 1 : 10;
+}
+
+int ReadAheadAudioSource::read_ahead(const int maximum_number_of_samples)
+{
+	if (fifo_.getFreeSpace() < jmin(static_cast<int>(chunk_size), fifo_.getTotalSize() - 1))
+	{
+		return 0;
+	}
+
+	int start1, size1, start2, size2;
+	fifo_.prepareToWrite(jmin(maximum_number_of_samples, fifo_.getFreeSpace()), start1, size1, start2, size2);
+
+	if (size1 > 0)
+	{
+		source_->getNextAudioBlock(AudioSourceChannelInfo(&buffer_, start1, size1));
+	}
+	if (size2 > 0)
+	{
+		source_->getNextAudioBlock(AudioSourceChannelInfo(&buffer_, start2, size2));
+	}
+	fifo_.finishedWrite(size1 + size2);
+
+	return size1 + size2;
+}
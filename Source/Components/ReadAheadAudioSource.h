@@ -0,0 +1,72 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "ISampleSource.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Reads a source ahead of playback on a TimeSliceThread shared by every instance,
+	into a FIFO of a configurable length. The audio thread only copies out of that
+	FIFO: when it runs dry the block is padded with silence and counted as an
+	underrun instead of waiting for the disk. prepareToPlay() rewinds the source and
+	reads its first blocks before returning, so it belongs on the message thread; the
+	shared thread reads the rest of the FIFO from there.
+*/
+class ReadAheadAudioSource : public ISampleSource,
+                             private TimeSliceClient
+{
+public:
+	// Shared by every sample source of the process through a SharedResourcePointer.
+	class ReadAheadThread : public TimeSliceThread
+	{
+	public:
+		ReadAheadThread();
+		~ReadAheadThread() override;
+	};
+
+	//==============================================================================
+	ReadAheadAudioSource(PositionableAudioSource* source, bool delete_source_when_deleted, int number_of_channels,
+	                     double read_ahead_in_seconds = 2.);
+	~ReadAheadAudioSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+	//==============================================================================
+	void set_read_ahead_length(double read_ahead_in_seconds) override;
+
+	int64 get_number_of_underruns() const noexcept override;
+	int64 get_number_of_missing_samples() const noexcept override;
+
+private:
+	int useTimeSlice() override;
+	int read_ahead(int maximum_number_of_samples);
+
+	//==============================================================================
+	enum
+	{
+		chunk_size = 2048,
+		prefill_blocks = 2
+	};
+
+	OptionalScopedPointer<PositionableAudioSource> source_;
+	const int number_of_channels_;
+	double read_ahead_in_seconds_;
+
+	AudioBuffer<float> buffer_;
+	AbstractFifo fifo_{1};
+	bool is_prepared_ = false;
+
+	std::atomic<int64> underruns_{0};
+	std::atomic<int64> missing_samples_{0};
+
+	// Taken by the read-ahead thread and by prepare / release; never by the audio thread.
+	CriticalSection source_lock_;
+
+	SharedResourcePointer<ReadAheadThread> read_ahead_thread_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReadAheadAudioSource)
+};
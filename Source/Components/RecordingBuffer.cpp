@@ -1,14 +1,61 @@
 #include "RecordingBuffer.h"
 
 
-RecordingBuffer::RecordingBuffer()
+RecordingBuffer::RecordingBuffer(const double capacity_in_seconds):
+	capacity_in_seconds_(capacity_in_seconds)
 {
 }
 
 RecordingBuffer::~RecordingBuffer()
 {
-	masterSource.setSource(nullptr);
-	buffer_ = nullptr;
+}
+
+void RecordingBuffer::prepare(const int number_of_channels, const int samplesPerBlockExpected,
+                              const double masterSourceSampleRate)
+{
+	// A power of two of at least one pyramid bucket keeps every channel on a 64-byte boundary,
+	// and twice the block size leaves readers a valid span beside the block being written.
+	const int max_block_size = jmax(1, samplesPerBlockExpected);
+	const int capacity = nextPowerOfTwo(jmax(static_cast<int>(PeakPyramid::largest_bucket_size),
+	                                         2 * max_block_size,
+	                                         roundToInt(capacity_in_seconds_ * masterSourceSampleRate)));
+	const int channels = jmax(1, number_of_channels);
+
+	const ScopedLock scoped_lock(storage_lock_);
+
+	sampleRate = masterSourceSampleRate;
+	max_block_size_ = max_block_size;
+
+	if (capacity != capacity_ || channels != number_of_channels_)
+	{
+		const size_t channel_size_in_bytes = sizeof(float) * static_cast<size_t>(capacity);
+		storage_.calloc(channel_size_in_bytes * channels + alignment_in_bytes);
+		channels_.calloc(channels);
+
+		auto* aligned_storage = reinterpret_cast<float*>(
+			(reinterpret_cast<pointer_sized_int>(storage_.get()) + alignment_in_bytes - 1)
+			& ~static_cast<pointer_sized_int>(alignment_in_bytes - 1));
+
+		for (int channel = 0; channel < channels; ++channel)
+		{
+			channels_[channel] = aligned_storage + static_cast<size_t>(channel) * capacity;
+		}
+
+		number_of_channels_ = channels;
+		capacity_ = capacity;
+		mask_ = capacity - 1;
+
+		peak_pyramid_.prepare(channels, capacity);
+	}
+	else
+	{
+		for (int channel = 0; channel < number_of_channels_; ++channel)
+		{
+			FloatVectorOperations::clear(channels_[channel], capacity_);
+		}
+	}
+
+	write_position_.store(0);
 }
 
 void RecordingBuffer::prepareToPlay(
@@ -16,126 +63,111 @@ void RecordingBuffer::prepareToPlay(
 	double masterSourceSampleRate
 )
 {
-	inputSampleRate = masterSourceSampleRate;
-	masterSource.prepareToPlay(
-		samplesPerBlockExpected, masterSourceSampleRate);
+	prepare(number_of_channels_, samplesPerBlockExpected, masterSourceSampleRate);
 }
 
 void RecordingBuffer::releaseResources()
 {
-	// auto test = recording_buffer_preallocation_thread_.get();
-	if (recording_buffer_preallocation_thread_.get() != nullptr)
-	{
-		recording_buffer_preallocation_thread_->stopThread(1000);
-	}
-
-	masterSource.releaseResources();
 }
 
 void RecordingBuffer::getNextAudioBlock(
 	const AudioSourceChannelInfo& bufferToFill
 )
 {
-	if (preallocated_recording_buffer_.getNumSamples() > 0)
+	if (capacity_ == 0)
 	{
-		for (int channel = 0; channel < 1; channel++)
-		{
-			jassert(preallocated_recording_buffer_.getNumSamples() <= buffer_size);
-			int number_samples_to_copy = (num_samples_recorded_ + bufferToFill.numSamples < buffer_size)
-				                             ? bufferToFill.numSamples
-				                             : buffer_size - num_samples_recorded_;
-			preallocated_recording_buffer_.copyFrom(
-				channel,
-				num_samples_recorded_,
-				*bufferToFill.buffer,
-				channel,
-				bufferToFill.startSample,
-				number_samples_to_copy
-			);
-
-			num_samples_recorded_ += number_samples_to_copy;
-
-			if (bufferToFill.numSamples > number_samples_to_copy)
-			{
-				const int start_sample_to_copy = bufferToFill.startSample + number_samples_to_copy;
-				number_samples_to_copy = bufferToFill.numSamples - number_samples_to_copy;
-
-				preallocated_recording_buffer_.copyFrom(
-					channel,
-					0,
-					*bufferToFill.buffer,
-					channel,
-					start_sample_to_copy,
-					number_samples_to_copy
-				);
-
-				num_samples_recorded_ = number_samples_to_copy;
-			}
-		}
-
-		buffer_->setDataToReferTo(
-			preallocated_recording_buffer_.getArrayOfWritePointers(),
-			preallocated_recording_buffer_.getNumChannels(),
-			preallocated_recording_buffer_.getNumSamples()
-		);
+		return;
 	}
-	else
+
+	// Larger blocks than prepared are written in prepared-size pieces, each published before the next
+	// overwrites anything, so readers' margin always covers the samples in flight. A block longer than
+	// the ring goes through it in order and only leaves its tail behind.
+	for (int offset = 0; offset < bufferToFill.numSamples; offset += max_block_size_)
 	{
-		DBG("BUFFER NOT SET");
+		write_block(*bufferToFill.buffer, bufferToFill.startSample + offset,
+		            jmin(max_block_size_, bufferToFill.numSamples - offset));
 	}
 }
 
-std::shared_ptr<AudioSampleBuffer> RecordingBuffer::loadRecordingBuffer(int number_of_samples_to_display)
+void RecordingBuffer::write_block(const AudioBuffer<float>& source_buffer, const int source_start,
+                                  const int number_of_samples) noexcept
 {
-	// TODO fix hardcoded number of channels
+	const int64 write_position = write_position_.load(std::memory_order_relaxed);
 
-	buffer_.reset(new AudioSampleBuffer(1, 0));
-	sampleRate = inputSampleRate;
-	num_samples_recorded_ = 0;
-	buffer_size = number_of_samples_to_display;
+	const int start = static_cast<int>(write_position & mask_);
+	const int first_span = jmin(number_of_samples, capacity_ - start);
+	const int number_of_source_channels = jmin(number_of_channels_, source_buffer.getNumChannels());
 
-	preallocated_recording_buffer_.setSize(
-		1,
-		(int)(buffer_size)
-	);
-	for (int sample = 0; sample < number_of_samples_to_display; ++sample)
+	// One pass over the block: each channel is at most two contiguous copies.
+	for (int channel = 0; channel < number_of_channels_; ++channel)
 	{
-		preallocated_recording_buffer_.setSample(0, sample, 0);
+		float* destination = channels_[channel];
+
+		if (channel < number_of_source_channels)
+		{
+			const float* source = source_buffer.getReadPointer(channel, source_start);
+			FloatVectorOperations::copy(destination + start, source, first_span);
+			FloatVectorOperations::copy(destination, source + first_span, number_of_samples - first_span);
+		}
+		else
+		{
+			FloatVectorOperations::clear(destination + start, first_span);
+			FloatVectorOperations::clear(destination, number_of_samples - first_span);
+		}
 	}
 
-	recording_buffer_preallocation_thread_.reset(
-		new BufferPreallocationThread(
-			preallocated_recording_buffer_,
-			num_samples_recorded_,
-			(int)(number_of_samples_to_display),
-			(int)(number_of_samples_to_display),
-			*buffer_
-		)
-	);
-	// recording_buffer_preallocation_thread_->startThread();
+	peak_pyramid_.add_samples(channels_.get(), mask_, write_position, number_of_samples);
 
-	std::unique_ptr<AudioBufferSource> tempBufferSource(
-		new AudioBufferSource(buffer_.get(), false)
-	);
+	write_position_.store(write_position + number_of_samples, std::memory_order_release);
+}
+
+//==============================================================================
+bool RecordingBuffer::copy_latest(AudioBuffer<float>& destination, const int number_of_samples) const
+{
+	const ScopedLock scoped_lock(storage_lock_);
 
-	masterSource.setSource(
-		tempBufferSource.get(),
-		0,
-		nullptr,
-		sampleRate
-	);
+	const int number_of_samples_to_copy = jmin(number_of_samples, destination.getNumSamples(),
+	                                           capacity_ - max_block_size_);
+	const int64 write_position = write_position_.load(std::memory_order_acquire);
 
-	bufferSource.swap(tempBufferSource);
+	// Before the ring has filled up, the oldest part of the span is silence.
+	const int number_of_silent_samples = static_cast<int>(jmax<int64>(0, number_of_samples_to_copy - write_position));
+	destination.clear(0, number_of_silent_samples);
 
-	jassert(preallocated_recording_buffer_.getNumSamples() <= buffer_size);
-	return buffer_;
+	copy_span(destination, number_of_silent_samples, write_position - number_of_samples_to_copy + number_of_silent_samples,
+	          number_of_samples_to_copy - number_of_silent_samples);
+
+	const int64 write_position_after_copy = write_position_.load(std::memory_order_acquire);
+	return get_first_valid_position(write_position_after_copy) <= write_position - number_of_samples_to_copy;
+}
+
+void RecordingBuffer::read_waveform_columns(const int channel, const int64 start_position,
+                                            const int64 end_position, PeakPyramid::Column* columns,
+                                            const int number_of_columns) const
+{
+	const ScopedLock scoped_lock(storage_lock_);
+
+	if (capacity_ == 0 || ! isPositiveAndBelow(channel, number_of_channels_) || number_of_columns <= 0)
+	{
+		std::fill(columns, columns + jmax(0, number_of_columns), PeakPyramid::Column());
+		return;
+	}
+
+	const int64 write_position = write_position_.load(std::memory_order_acquire);
+
+	// The oldest span is left out: the writer may be overwriting it while we read.
+	const int64 oldest_position = jmax<int64>(0, write_position - capacity_
+	                                          + jmax<int>(PeakPyramid::largest_bucket_size, max_block_size_));
+
+	peak_pyramid_.read_columns(channel, start_position, end_position, columns, number_of_columns,
+	                           channels_[channel], mask_, oldest_position, write_position);
 }
 
 double RecordingBuffer::getLengthInSeconds() const
 {
-	if (buffer_ != nullptr)
+	if (sampleRate > 0.0)
 	{
-		return buffer_->getNumSamples() / sampleRate;
+		return capacity_ / sampleRate;
 	}
 	else
 	{
@@ -148,66 +180,129 @@ double RecordingBuffer::getSampleRate() const
 	return sampleRate;
 }
 
+int RecordingBuffer::get_number_of_channels() const noexcept
+{
+	return number_of_channels_;
+}
+
+int RecordingBuffer::get_capacity() const noexcept
+{
+	return capacity_;
+}
+
+int64 RecordingBuffer::get_write_position() const noexcept
+{
+	return write_position_.load(std::memory_order_acquire);
+}
 
-const CriticalSection* RecordingBuffer::getBufferUpdateLock() const noexcept
+const float* RecordingBuffer::get_channel_pointer(const int channel) const noexcept
 {
-	if (recording_buffer_preallocation_thread_)
+	jassert(isPositiveAndBelow(channel, number_of_channels_));
+	return channels_[channel];
+}
+
+void RecordingBuffer::copy_span(AudioBuffer<float>& destination, const int destination_start, const int64 position,
+                                const int number_of_samples) const noexcept
+{
+	if (number_of_samples <= 0)
 	{
-		return &recording_buffer_preallocation_thread_->getLock();
+		return;
 	}
-	else
+
+	const int start = static_cast<int>(position & mask_);
+	const int first_span = jmin(number_of_samples, capacity_ - start);
+
+	for (int channel = 0; channel < destination.getNumChannels(); ++channel)
 	{
-		return nullptr;
+		if (channel < number_of_channels_)
+		{
+			destination.copyFrom(channel, destination_start, channels_[channel] + start, first_span);
+			destination.copyFrom(channel, destination_start + first_span, channels_[channel],
+			                     number_of_samples - first_span);
+		}
+		else
+		{
+			destination.clear(channel, destination_start, number_of_samples);
+		}
 	}
 }
 
-int RecordingBuffer::get_sample_index() const
+int64 RecordingBuffer::get_first_valid_position(const int64 write_position) const noexcept
 {
-	return num_samples_recorded_;
+	return write_position - capacity_ + max_block_size_;
 }
 
 // ==============================================================================
-RecordingBuffer::BufferPreallocationThread::BufferPreallocationThread(
-	AudioSampleBuffer& preallocatedRecordingBuffer,
-	int& numSamplesRecorded,
-	int numSamplesBuffer,
-	int numSamplesToAllocate,
-	AudioSampleBuffer& buffer
-) :
-	Thread("BufferPreallocationThread"),
-	preallocatedRecordingBuffer(preallocatedRecordingBuffer),
-	num_samples_recorded_(numSamplesRecorded),
-	num_samples_buffer_(numSamplesBuffer),
-	num_samples_to_allocate_(numSamplesToAllocate),
-	buffer(buffer)
+RecordingBuffer::Reader::Reader(const RecordingBuffer& recording_buffer):
+	recording_buffer_(recording_buffer),
+	read_position_(recording_buffer.get_write_position())
 {
 }
 
-void RecordingBuffer::BufferPreallocationThread::run()
+int RecordingBuffer::Reader::read(AudioBuffer<float>& destination)
 {
-	while (!threadShouldExit())
+	const ScopedLock scoped_lock(recording_buffer_.storage_lock_);
+
+	const int64 write_position = recording_buffer_.write_position_.load(std::memory_order_acquire);
+	int64 read_position = read_position_.load(std::memory_order_relaxed);
+
+	if (read_position > write_position)
+	{
+		// The ring was prepared again since the last read.
+		read_position = write_position;
+	}
+	const int64 first_readable_position = recording_buffer_.get_first_valid_position(write_position);
+	if (read_position < first_readable_position)
 	{
-		const int preallocatedSamples = preallocatedRecordingBuffer.getNumSamples();
-		if (preallocatedSamples - num_samples_recorded_ < num_samples_buffer_)
+		dropped_samples_ += first_readable_position - read_position;
+		read_position = first_readable_position;
+	}
+
+	int number_of_samples = static_cast<int>(jmin<int64>(write_position - read_position,
+	                                                     destination.getNumSamples()));
+	recording_buffer_.copy_span(destination, 0, read_position, number_of_samples);
+
+	// Anything the writer overwrote while we were copying is discarded rather than returned torn.
+	const int64 first_valid_position = recording_buffer_.get_first_valid_position(
+		recording_buffer_.write_position_.load(std::memory_order_acquire));
+
+	if (first_valid_position > read_position)
+	{
+		const int number_of_torn_samples = static_cast<int>(jmin<int64>(first_valid_position - read_position,
+		                                                                 number_of_samples));
+		number_of_samples -= number_of_torn_samples;
+
+		for (int channel = 0; channel < destination.getNumChannels(); ++channel)
 		{
-			const int newNumSamples =
-				preallocatedRecordingBuffer.getNumSamples() + num_samples_to_allocate_;
-			const ScopedLock scopedLock(bufferUpdateLock);
-			preallocatedRecordingBuffer.setSize(
-				preallocatedRecordingBuffer.getNumChannels(),
-				newNumSamples, true
-			);
-			buffer.setDataToReferTo(
-				preallocatedRecordingBuffer.getArrayOfWritePointers(),
-				preallocatedRecordingBuffer.getNumChannels(),
-				num_samples_recorded_
-			);
+			float* samples = destination.getWritePointer(channel);
+			std::memmove(samples, samples + number_of_torn_samples, sizeof(float) * number_of_samples);
 		}
-		wait(1000);
+
+		dropped_samples_ += first_valid_position - read_position;
+		read_position = first_valid_position;
 	}
+
+	read_position_.store(read_position + number_of_samples, std::memory_order_release);
+	return number_of_samples;
+}
+
+void RecordingBuffer::Reader::skip_to_latest() noexcept
+{
+	read_position_.store(recording_buffer_.get_write_position(), std::memory_order_release);
+}
+
+int64 RecordingBuffer::Reader::get_read_position() const noexcept
+{
+	return read_position_.load(std::memory_order_acquire);
+}
+
+int64 RecordingBuffer::Reader::get_number_of_available_samples() const noexcept
+{
+	return jmin<int64>(recording_buffer_.get_write_position() - get_read_position(),
+	                   recording_buffer_.get_capacity() - recording_buffer_.max_block_size_);
 }
 
-const CriticalSection& RecordingBuffer::BufferPreallocationThread::getLock() const noexcept
+int64 RecordingBuffer::Reader::get_number_of_dropped_samples() const noexcept
 {
-	return bufferUpdateLock;
+	return dropped_samples_.load(std::memory_order_relaxed);
 }
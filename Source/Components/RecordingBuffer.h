@@ -2,15 +2,28 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 
-#include "AudioBufferSource.h"
-
-
+#include "PeakPyramid.h"
+
+//==============================================================================
+/*
+	Keeps the last few seconds of audio in a fixed, power-of-two, multi-channel ring.
+	The audio thread is the only writer: it copies each block in and publishes the new
+	write position, never allocating, locking or waiting for anyone. Readers keep their
+	own read position and detect when the writer lapped them, so every span they get
+	back is consistent. The writer overwrites at most max_block_size_ samples before
+	publishing them, so readers treat that many of the oldest samples as invalid.
+	Storage is only resized in prepare(), from the bus layout, and is planar with every
+	channel starting on a cache line. A PeakPyramid follows the ring so waveforms can
+	be drawn without touching the samples.
+*/
 class RecordingBuffer : public AudioSource
 {
 public:
-	RecordingBuffer();
+	explicit RecordingBuffer(double capacity_in_seconds = 10.);
+
+	~RecordingBuffer() override;
 
-	~RecordingBuffer();
+	void prepare(int number_of_channels, int samplesPerBlockExpected, double sampleRate);
 
 	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
 
@@ -18,60 +31,75 @@ public:
 
 	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
 
-	std::shared_ptr<AudioSampleBuffer> loadRecordingBuffer(int number_of_samples_to_display);
+	//==============================================================================
+	bool copy_latest(AudioBuffer<float>& destination, int number_of_samples) const;
+
+	void read_waveform_columns(int channel, int64 start_position, int64 end_position,
+	                           PeakPyramid::Column* columns, int number_of_columns) const;
 
 	double getLengthInSeconds() const;
 
 	double getSampleRate() const;
 
-	const CriticalSection* getBufferUpdateLock() const noexcept;
+	int get_number_of_channels() const noexcept;
 
-	int get_sample_index() const;
+	int get_capacity() const noexcept;
 
+	int64 get_write_position() const noexcept;
 
-private:
-	class BufferPreallocationThread;
+	// Ring storage of one channel, capacity samples long; position p lives at p & (capacity - 1).
+	const float* get_channel_pointer(int channel) const noexcept;
 
-private:
-	AudioTransportSource masterSource;
-	std::unique_ptr<AudioBufferSource> bufferSource;
+	//==============================================================================
+	class Reader
+	{
+	public:
+		explicit Reader(const RecordingBuffer& recording_buffer);
 
-	std::shared_ptr<AudioSampleBuffer> buffer_;
-	std::unique_ptr<AudioSampleBuffer> subregion_buffer_;
+		int read(AudioBuffer<float>& destination);
+		void skip_to_latest() noexcept;
 
-	AudioSampleBuffer preallocated_recording_buffer_;
-	std::unique_ptr<BufferPreallocationThread> recording_buffer_preallocation_thread_;
-	int num_samples_recorded_ = 0;
+		int64 get_read_position() const noexcept;
+		int64 get_number_of_available_samples() const noexcept;
+		int64 get_number_of_dropped_samples() const noexcept;
 
-	double sampleRate = 0.0;
-	double inputSampleRate = 0.0;
-	int buffer_size;
+	private:
+		const RecordingBuffer& recording_buffer_;
+		std::atomic<int64> read_position_;
+		std::atomic<int64> dropped_samples_{0};
 
-	bool hasSubregion = false;
-	double subregionStartTime = 0.0;
-	double subregionEndTime = 0.0;
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Reader)
+	};
 
-	class BufferPreallocationThread : public Thread
+private:
+	void write_block(const AudioBuffer<float>& source, int source_start, int number_of_samples) noexcept;
+	void copy_span(AudioBuffer<float>& destination, int destination_start, int64 position,
+	               int number_of_samples) const noexcept;
+	// The oldest position a reader may trust, given a write position it loaded.
+	int64 get_first_valid_position(int64 write_position) const noexcept;
+
+	//==============================================================================
+	enum
 	{
-	public:
-		BufferPreallocationThread(
-			AudioSampleBuffer& preallocatedRecordingBuffer,
-			int& numSamplesRecorded,
-			int numSamplesBuffer,
-			int numSamplesToAllocate,
-			AudioSampleBuffer& buffer
-		);
+		alignment_in_bytes = 64
+	};
 
-		void run() override;
+	const double capacity_in_seconds_;
 
-		const CriticalSection& getLock() const noexcept;
+	HeapBlock<char> storage_;
+	HeapBlock<float*> channels_;
+	int number_of_channels_ = 0;
+	int capacity_ = 0;
+	int mask_ = 0;
+	int max_block_size_ = 0;
+	std::atomic<int64> write_position_{0};
 
-	private:
-		AudioSampleBuffer& preallocatedRecordingBuffer;
-		int& num_samples_recorded_;
-		int num_samples_buffer_;
-		int num_samples_to_allocate_;
-		AudioSampleBuffer& buffer;
-		const CriticalSection bufferUpdateLock;
-	};
+	PeakPyramid peak_pyramid_;
+
+	double sampleRate = 0.0;
+
+	// Guards storage_ against prepareToPlay() for readers; the audio thread never takes it.
+	CriticalSection storage_lock_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordingBuffer)
 };
@@ -0,0 +1,59 @@
+#include "RefreshScheduler.h"
+
+RefreshScheduler::RefreshScheduler(Component& owner): owner_(owner)
+#if JUCE_MAJOR_VERSION >= 7
+                                                      , vblank_attachment_(&owner, [this] { on_frame(); })
+#endif
+{
+#if JUCE_MAJOR_VERSION < 7
+	startTimerHz(refresh_rate_in_hz);
+#endif
+}
+
+RefreshScheduler::~RefreshScheduler()
+{
+#if JUCE_MAJOR_VERSION < 7
+	stopTimer();
+#endif
+}
+
+void RefreshScheduler::add_client(Client* client)
+{
+	clients_.addIfNotAlreadyThere(client);
+}
+
+void RefreshScheduler::remove_client(Client* client)
+{
+	clients_.removeFirstMatchingValue(client);
+}
+
+void RefreshScheduler::on_frame()
+{
+	const bool is_showing = owner_.isShowing();
+
+#if JUCE_MAJOR_VERSION < 7
+	const int rate_in_hz = is_showing ? refresh_rate_in_hz : hidden_probe_rate_in_hz;
+
+	if (getTimerInterval() != 1000 / rate_in_hz)
+	{
+		startTimerHz(rate_in_hz);
+	}
+#endif
+
+	if (! is_showing)
+	{
+		return;
+	}
+
+	for (auto* client : clients_)
+	{
+		client->refresh();
+	}
+}
+
+#if JUCE_MAJOR_VERSION < 7
+void RefreshScheduler::timerCallback()
+{
+	on_frame();
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	One display-rate tick shared by every view of an editor. With JUCE 7 it follows
+	the owner's vblank; older versions fall back to a single 60 Hz timer. Clients are
+	called in registration order and only repaint when their source's generation
+	counter moved. While the owner is not showing, clients are skipped and the
+	fallback timer drops to a slow probe, so a hidden editor costs almost nothing.
+*/
+class RefreshScheduler
+#if JUCE_MAJOR_VERSION < 7
+	: private Timer
+#endif
+{
+public:
+	class Client
+	{
+	public:
+		virtual ~Client() = default;
+
+		virtual void refresh() = 0;
+	};
+
+	explicit RefreshScheduler(Component& owner);
+	~RefreshScheduler();
+
+	void add_client(Client* client);
+	void remove_client(Client* client);
+
+private:
+	void on_frame();
+#if JUCE_MAJOR_VERSION < 7
+	void timerCallback() override;
+#endif
+	//==============================================================================
+	enum
+	{
+		refresh_rate_in_hz = 60,
+		hidden_probe_rate_in_hz = 2
+	};
+
+	Component& owner_;
+	Array<Client*> clients_;
+
+#if JUCE_MAJOR_VERSION >= 7
+	VBlankAttachment vblank_attachment_;
+#endif
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RefreshScheduler)
+};
@@ -0,0 +1,109 @@
+#include "ResamplingReaderSource.h"
+
+ResamplingReaderSource::ResamplingReaderSource(AudioFormatReader* reader):
+	reader_(reader),
+	output_length_(reader->lengthInSamples)
+{
+}
+
+ResamplingReaderSource::~ResamplingReaderSource() = default;
+
+void ResamplingReaderSource::prepareToPlay(int, const double sampleRate)
+{
+	if (sampleRate <= 0. || sampleRate == target_sample_rate_)
+	{
+		return;
+	}
+
+	target_sample_rate_ = sampleRate;
+	if (reader_->sampleRate > 0. && reader_->sampleRate != sampleRate)
+	{
+		resampler_ = std::make_unique<SincResampler>(reader_->sampleRate, sampleRate);
+		output_length_ = static_cast<int64>(std::ceil(reader_->lengthInSamples * sampleRate / reader_->sampleRate));
+	}
+	else
+	{
+		resampler_.reset();
+		output_length_ = reader_->lengthInSamples;
+	}
+}
+
+void ResamplingReaderSource::releaseResources()
+{
+	// The phase table can reach a few megabytes for uncommon ratios; prepareToPlay() builds it again.
+	resampler_.reset();
+	target_sample_rate_ = 0.;
+	input_buffer_.setSize(0, 0);
+}
+
+void ResamplingReaderSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	if (output_length_ <= 0)
+	{
+		bufferToFill.clearActiveBufferRegion();
+		return;
+	}
+
+	for (int number_of_samples_read = 0; number_of_samples_read < bufferToFill.numSamples;)
+	{
+		const int64 position = position_ % output_length_;
+		const int length = static_cast<int>(jmin(static_cast<int64>(bufferToFill.numSamples - number_of_samples_read),
+		                                         output_length_ - position, static_cast<int64>(chunk_size)));
+
+		read(*bufferToFill.buffer, bufferToFill.startSample + number_of_samples_read, position, length);
+
+		position_ = position + length;
+		number_of_samples_read += length;
+	}
+}
+
+void ResamplingReaderSource::setNextReadPosition(const int64 newPosition)
+{
+	position_ = newPosition;
+}
+
+int64 ResamplingReaderSource::getNextReadPosition() const
+{
+	return (output_length_ > 0) ? position_ % output_length_ : 0;
+}
+
+int64 ResamplingReaderSource::getTotalLength() const
+{
+	return output_length_;
+}
+
+bool ResamplingReaderSource::isLooping() const
+{
+	return true;
+}
+
+//==============================================================================
+void ResamplingReaderSource::read(AudioBuffer<float>& buffer, const int start_sample, const int64 first_output,
+                                  const int number_of_outputs)
+{
+	if (resampler_ == nullptr)
+	{
+		reader_->read(&buffer, start_sample, number_of_outputs, first_output, true, true);
+		return;
+	}
+
+	// Only the part of the window inside the file is read; the converter takes the rest as silence.
+	const auto window = resampler_->get_input_range(first_output, number_of_outputs)
+		.getIntersectionWith({0, reader_->lengthInSamples});
+	if (window.isEmpty())
+	{
+		buffer.clear(start_sample, number_of_outputs);
+		return;
+	}
+
+	// On the read-ahead thread, so growing the window here is fine.
+	const int window_length = static_cast<int>(window.getLength());
+	input_buffer_.setSize(buffer.getNumChannels(), window_length, false, false, true);
+	reader_->read(&input_buffer_, 0, window_length, window.getStart(), true, true);
+
+	for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+	{
+		resampler_->process_window(input_buffer_.getReadPointer(channel), window.getStart(), window_length,
+		                           buffer.getWritePointer(channel, start_sample), first_output, number_of_outputs);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "SincResampler.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Loops a reader converted to the rate it is prepared at. It sits behind a
+	ReadAheadAudioSource, so decoding and the sinc conversion both run on the shared
+	read-ahead thread: samples too large for the cache still play at the host rate.
+	Each pass of the loop is converted on its own, with silence past both ends of the
+	file, so the seam is no harder than an unconverted loop. The converter is only
+	built while prepared.
+*/
+class ResamplingReaderSource : public PositionableAudioSource
+{
+public:
+	explicit ResamplingReaderSource(AudioFormatReader* reader);
+	~ResamplingReaderSource() override;
+
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	void releaseResources() override;
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+	void setNextReadPosition(int64 newPosition) override;
+	int64 getNextReadPosition() const override;
+	int64 getTotalLength() const override;
+	bool isLooping() const override;
+
+private:
+	void read(AudioBuffer<float>& buffer, int start_sample, int64 first_output, int number_of_outputs);
+
+	//==============================================================================
+	enum
+	{
+		chunk_size = 2048
+	};
+
+	std::unique_ptr<AudioFormatReader> reader_;
+
+	// Null when the reader is already at the target rate.
+	std::unique_ptr<SincResampler> resampler_;
+	double target_sample_rate_ = 0.;
+	int64 output_length_ = 0;
+	int64 position_ = 0;
+
+	AudioBuffer<float> input_buffer_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResamplingReaderSource)
+};
@@ -0,0 +1,241 @@
+#include "SampleCache.h"
+
+SampleCache::DecodedSample::DecodedSample(const int number_of_channels, const int length_in_samples,
+                                          const double sample_rate):
+	buffer(number_of_channels, length_in_samples),
+	sample_rate(sample_rate)
+{
+}
+
+int SampleCache::DecodedSample::get_number_of_samples_ready() const noexcept
+{
+	return number_of_samples_ready_.load(std::memory_order_acquire);
+}
+
+bool SampleCache::DecodedSample::is_ready() const noexcept
+{
+	return get_number_of_samples_ready() == buffer.getNumSamples();
+}
+
+size_t SampleCache::DecodedSample::get_size_in_bytes() const noexcept
+{
+	return static_cast<size_t>(buffer.getNumChannels()) * static_cast<size_t>(buffer.getNumSamples()) * sizeof(float);
+}
+
+//==============================================================================
+SampleCache::SampleCache()
+{
+	audio_format_manager_.registerBasicFormats();
+}
+
+SampleCache::~SampleCache()
+{
+	conversion_pool_.removeAllJobs(true, 4000);
+}
+
+SampleCache::DecodedSample::Ptr SampleCache::get_sample(const File& file, const double target_sample_rate)
+{
+	const auto key = get_key(file, target_sample_rate);
+	if (auto sample = find_sample(key))
+	{
+		return sample;
+	}
+
+	// The lock is shared by every instance, so the header is read and the buffer allocated
+	// without it; the samples themselves are left to the conversion job.
+	const std::unique_ptr<AudioFormatReader> reader(audio_format_manager_.createReaderFor(file));
+	if (reader == nullptr || reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+	{
+		return nullptr;
+	}
+
+	const double sample_rate = (target_sample_rate > 0.) ? target_sample_rate : reader->sampleRate;
+	const int length = SincResampler::get_output_length(reader->sampleRate, sample_rate,
+	                                                    static_cast<int>(reader->lengthInSamples));
+
+	DecodedSample::Ptr sample = new DecodedSample(static_cast<int>(reader->numChannels), length, sample_rate);
+
+	const ScopedLock lock(lock_);
+
+	// Another instance may have cached the same file meanwhile: its decoding is kept.
+	if (auto cached_sample = find_sample_locked(key))
+	{
+		return cached_sample;
+	}
+
+	entries_.push_front({key, sample});
+	entries_by_key_[key] = entries_.begin();
+	memory_used_ += sample->get_size_in_bytes();
+
+	conversion_pool_.addJob(new ConversionJob(*this, file, sample), true);
+
+	trim_locked();
+	return sample;
+}
+
+SampleCache::DecodedSample::Ptr SampleCache::find_sample(const String& key)
+{
+	const ScopedLock lock(lock_);
+	return find_sample_locked(key);
+}
+
+SampleCache::DecodedSample::Ptr SampleCache::find_sample_locked(const String& key)
+{
+	const auto entry = entries_by_key_.find(key);
+	if (entry == entries_by_key_.end())
+	{
+		return nullptr;
+	}
+
+	entries_.splice(entries_.begin(), entries_, entry->second);
+	return entry->second->sample;
+}
+
+bool SampleCache::can_cache(const int64 length_in_samples, const int number_of_channels, const double sample_rate,
+                            const double target_sample_rate) const
+{
+	const double ratio = (sample_rate > 0. && target_sample_rate > 0.) ? target_sample_rate / sample_rate : 1.;
+	const double size_in_bytes = static_cast<double>(length_in_samples) * ratio * number_of_channels * sizeof(float);
+
+	const ScopedLock lock(lock_);
+	return size_in_bytes <= static_cast<double>(memory_budget_) / 4.;
+}
+
+void SampleCache::set_memory_budget(const size_t budget_in_bytes)
+{
+	const ScopedLock lock(lock_);
+	memory_budget_ = budget_in_bytes;
+	trim_locked();
+}
+
+size_t SampleCache::get_memory_budget() const
+{
+	const ScopedLock lock(lock_);
+	return memory_budget_;
+}
+
+size_t SampleCache::get_memory_used() const
+{
+	const ScopedLock lock(lock_);
+	return memory_used_;
+}
+
+void SampleCache::trim()
+{
+	const ScopedLock lock(lock_);
+	trim_locked();
+}
+
+//==============================================================================
+SampleCache::ConversionJob::ConversionJob(SampleCache& owner, const File& file, DecodedSample::Ptr sample):
+	ThreadPoolJob("Foley sample conversion"),
+	owner_(owner),
+	file_(file),
+	sample_(std::move(sample))
+{
+}
+
+ThreadPoolJob::JobStatus SampleCache::ConversionJob::runJob()
+{
+	auto& buffer = sample_->buffer;
+
+	const std::unique_ptr<AudioFormatReader> reader(owner_.audio_format_manager_.createReaderFor(file_));
+	if (reader == nullptr)
+	{
+		// Gone since the header was read: it plays as silence rather than staying pending.
+		buffer.clear();
+		publish(buffer.getNumSamples());
+		return jobHasFinished;
+	}
+
+	const int length = static_cast<int>(jmin<int64>(reader->lengthInSamples, buffer.getNumSamples()));
+	const bool needs_conversion = reader->sampleRate != sample_->sample_rate;
+
+	// Converted samples are decoded aside first: the resampler reads around each output.
+	AudioBuffer<float> file_buffer;
+	std::unique_ptr<SincResampler> resampler;
+	if (needs_conversion)
+	{
+		file_buffer.setSize(buffer.getNumChannels(), static_cast<int>(reader->lengthInSamples));
+		resampler = std::make_unique<SincResampler>(reader->sampleRate, sample_->sample_rate);
+	}
+	auto& decoded_buffer = needs_conversion ? file_buffer : buffer;
+	const int decoded_length = decoded_buffer.getNumSamples();
+
+	int number_of_samples_decoded = 0;
+	int number_of_samples_converted = 0;
+
+	while (number_of_samples_decoded < decoded_length)
+	{
+		if (shouldExit())
+		{
+			return jobHasFinished;
+		}
+
+		const int number_of_samples = jmin(static_cast<int>(chunk_size), decoded_length - number_of_samples_decoded);
+		reader->read(&decoded_buffer, number_of_samples_decoded, number_of_samples, number_of_samples_decoded, true,
+		             true);
+		number_of_samples_decoded += number_of_samples;
+
+		if (! needs_conversion)
+		{
+			publish(jmin(number_of_samples_decoded, length));
+			continue;
+		}
+
+		const int end = (number_of_samples_decoded == decoded_length)
+			                ? buffer.getNumSamples()
+			                : jmin(buffer.getNumSamples(),
+			                       resampler->get_number_of_complete_outputs(number_of_samples_decoded));
+
+		for (int channel = 0; channel < buffer.getNumChannels() && end > number_of_samples_converted; ++channel)
+		{
+			resampler->process(file_buffer.getReadPointer(channel), number_of_samples_decoded,
+			                   buffer.getWritePointer(channel), number_of_samples_converted,
+			                   end - number_of_samples_converted);
+		}
+		number_of_samples_converted = jmax(number_of_samples_converted, end);
+		publish(number_of_samples_converted);
+	}
+
+	if (sample_->get_number_of_samples_ready() < buffer.getNumSamples())
+	{
+		const int ready = sample_->get_number_of_samples_ready();
+		buffer.clear(ready, buffer.getNumSamples() - ready);
+		publish(buffer.getNumSamples());
+	}
+	return jobHasFinished;
+}
+
+void SampleCache::ConversionJob::publish(const int number_of_samples_ready)
+{
+	sample_->number_of_samples_ready_.store(number_of_samples_ready, std::memory_order_release);
+}
+
+//==============================================================================
+String SampleCache::get_key(const File& file, const double target_sample_rate)
+{
+	// A file rewritten in place gets a new key, so its stale decoding just ages out.
+	return file.getFullPathName()
+		+ "|" + String(file.getLastModificationTime().toMilliseconds())
+		+ "|" + String(file.getSize())
+		+ "|" + String(target_sample_rate);
+}
+
+void SampleCache::trim_locked()
+{
+	for (auto entry = entries_.end(); memory_used_ > memory_budget_ && entry != entries_.begin();)
+	{
+		--entry;
+
+		// Held elsewhere, maybe by the audio thread: it waits for a later trim.
+		if (entry->sample->getReferenceCount() > 1)
+		{
+			continue;
+		}
+
+		memory_used_ -= entry->sample->get_size_in_bytes();
+		entries_by_key_.erase(entry->key);
+		entry = entries_.erase(entry);
+	}
+}
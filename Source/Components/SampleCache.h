@@ -0,0 +1,113 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "SincResampler.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Decoded foley samples shared by every plugin instance of the process, through a
+	SharedResourcePointer. A sample is cached once per file version and target sample
+	rate, as a float buffer already converted to that rate. Any format the format
+	manager knows is accepted: decoding and conversion run in chunks on a small pool
+	of worker threads, and a handle is returned at once. Its buffer fills from the
+	start, and only the first get_number_of_samples_ready() samples may be read, so
+	a sample plays from its first chunk while the rest is decoded. The least recently
+	used samples are evicted once the memory budget is exceeded; a sample still held
+	by a DecodedSample::Ptr is never freed, and only goes once its last user releases it.
+*/
+class SampleCache
+{
+public:
+	class DecodedSample : public ReferenceCountedObject
+	{
+	public:
+		using Ptr = ReferenceCountedObjectPtr<DecodedSample>;
+
+		DecodedSample(int number_of_channels, int length_in_samples, double sample_rate);
+
+		// Written by the conversion job only; the ready part is never written again.
+		AudioBuffer<float> buffer;
+		const double sample_rate;
+
+		int get_number_of_samples_ready() const noexcept;
+		bool is_ready() const noexcept;
+		size_t get_size_in_bytes() const noexcept;
+
+	private:
+		friend class SampleCache;
+		std::atomic<int> number_of_samples_ready_{0};
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecodedSample)
+	};
+
+	//==============================================================================
+	SampleCache();
+	~SampleCache();
+
+	// Reads the file header on a miss, so never call it from the audio thread.
+	DecodedSample::Ptr get_sample(const File& file, double target_sample_rate);
+
+	// Whether a sample of this size could stay cached without evicting most of the others.
+	bool can_cache(int64 length_in_samples, int number_of_channels, double sample_rate,
+	               double target_sample_rate) const;
+
+	void set_memory_budget(size_t budget_in_bytes);
+	size_t get_memory_budget() const;
+	size_t get_memory_used() const;
+
+	// Evicts what went over budget while still in use; worth calling once handles are released.
+	void trim();
+
+private:
+	struct Entry
+	{
+		String key;
+		DecodedSample::Ptr sample;
+	};
+
+	// Holds its sample, which keeps it from being evicted before it is converted.
+	class ConversionJob : public ThreadPoolJob
+	{
+	public:
+		ConversionJob(SampleCache& owner, const File& file, DecodedSample::Ptr sample);
+
+		JobStatus runJob() override;
+
+	private:
+		enum
+		{
+			chunk_size = 32768
+		};
+
+		void publish(int number_of_samples_ready);
+		//==============================================================================
+		SampleCache& owner_;
+		const File file_;
+		const DecodedSample::Ptr sample_;
+	};
+
+	static String get_key(const File& file, double target_sample_rate);
+	// Moves the entry to the front; null when the key is not cached.
+	DecodedSample::Ptr find_sample(const String& key);
+	DecodedSample::Ptr find_sample_locked(const String& key);
+	void trim_locked();
+	//==============================================================================
+	CriticalSection lock_;
+	// Most recently used first.
+	std::list<Entry> entries_;
+	std::map<String, std::list<Entry>::iterator> entries_by_key_;
+
+	size_t memory_budget_ = 256 * 1024 * 1024;
+	size_t memory_used_ = 0;
+
+	// Formats are only registered on construction, so readers are created from any thread.
+	AudioFormatManager audio_format_manager_;
+
+	// Last, so its jobs are gone before anything they use is destroyed. Bounded, so a
+	// library of compressed files being browsed cannot take every core.
+	ThreadPool conversion_pool_{jlimit(1, 4, SystemStats::getNumCpus() / 2)};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleCache)
+};
@@ -2,8 +2,8 @@
 #include "SampleComponent.h"
 
 //==============================================================================
-SampleComponent::SampleComponent(const FoleyInput::FileAudioSource* sample) :
-	SelectorElement(sample->file.getFileNameWithoutExtension()), file_audio_source(sample)
+SampleComponent::SampleComponent() :
+	SelectorElement(String())
 {
 }
 
@@ -11,3 +11,9 @@ SampleComponent::~SampleComponent()
 {
 }
 
+void SampleComponent::set_sample(const int index, const String& name)
+{
+	sample_index = index;
+	setName(name);
+	repaint();
+}
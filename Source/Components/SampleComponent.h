@@ -1,16 +1,18 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "FoleyInput.h"
 #include "SelectorElement.h"
 
+// A cell of the sample list; rows are recycled, so it is re-targeted with set_sample().
 class SampleComponent : public SelectorElement
 {
 public:
-	SampleComponent(const FoleyInput::FileAudioSource* sample);
+	SampleComponent();
 	~SampleComponent() override;
 
-	const FoleyInput::FileAudioSource* file_audio_source;
+	void set_sample(int index, const String& name);
+
+	int sample_index = -1;
 
 private:
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleComponent)
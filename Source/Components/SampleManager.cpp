@@ -7,6 +7,8 @@ SampleManager::SampleManager(FoleyInput* foley_input): foley_input_(foley_input)
 	setup_library_name_label();
 	setup_selector_name_label();
 	setup_load_library_button();
+	setup_granular_button();
+	setup_layer_controls();
 
 	children_ = {&sample_selector_, &library_selector_};
 	show_samples_selector();
@@ -18,6 +20,15 @@ SampleManager::SampleManager(FoleyInput* foley_input): foley_input_(foley_input)
 		display_library_name();
 		
 	};
+
+	foley_input_->addChangeListener(this);
+}
+
+void SampleManager::changeListenerCallback(ChangeBroadcaster*)
+{
+	library_selector_.reload_libraries();
+	sample_selector_.reload_samples();
+	display_library_name();
 }
 
 void SampleManager::setup_load_library_button()
@@ -31,6 +42,80 @@ void SampleManager::setup_load_library_button()
 	};
 }
 
+void SampleManager::setup_granular_button()
+{
+	addAndMakeVisible(granular_);
+	granular_.setButtonText("GRAINS");
+	granular_.setClickingTogglesState(true);
+	granular_.setToggleState(foley_input_->get_playback_mode() == FoleyInput::GRANULAR, dontSendNotification);
+	granular_.onClick = [this]()
+	{
+		foley_input_->set_playback_mode(granular_.getToggleState() ? FoleyInput::GRANULAR : FoleyInput::LOOP);
+	};
+}
+
+void SampleManager::setup_layer_controls()
+{
+	for (int layer = 0; layer < FoleyInput::max_layers; ++layer)
+	{
+		auto& layer_button = layer_buttons_[static_cast<size_t>(layer)];
+		addAndMakeVisible(layer_button);
+		layer_button.setButtonText("LAYER " + String(layer + 1));
+		layer_button.setRadioGroupId(1);
+		layer_button.setClickingTogglesState(true);
+		layer_button.onClick = [this, layer]()
+		{
+			select_layer(layer);
+		};
+	}
+
+	// Item ids are the modulation sources, shifted by one since 0 means no selection.
+	addAndMakeVisible(layer_routing_);
+	layer_routing_.addItem("Unrouted", FoleyInput::UNROUTED + 1);
+	layer_routing_.addItem("Volume", FoleyInput::VOLUME + 1);
+	layer_routing_.addItem("Band energy", FoleyInput::BAND_ENERGY + 1);
+	layer_routing_.addItem("Frequency", FoleyInput::FREQUENCY + 1);
+	// Sources this version does not analyse stay listed, but cannot be picked.
+	for (int source = FoleyInput::UNROUTED; source < FoleyInput::number_of_modulation_sources; ++source)
+	{
+		layer_routing_.setItemEnabled(source + 1, foley_input_->has_modulation_analyzer(
+			                              static_cast<FoleyInput::modulation_source>(source)));
+	}
+	layer_routing_.onChange = [this]()
+	{
+		foley_input_->set_layer_routing(foley_input_->get_selected_layer(),
+		                                static_cast<FoleyInput::modulation_source>(
+			                                layer_routing_.getSelectedId() - 1));
+	};
+
+	addAndMakeVisible(layer_gain_);
+	layer_gain_.setRange(0., 1.);
+	layer_gain_.onValueChange = [this]()
+	{
+		foley_input_->set_layer_gain(foley_input_->get_selected_layer(), static_cast<float>(layer_gain_.getValue()));
+	};
+
+	display_layer_controls();
+}
+
+void SampleManager::select_layer(const int layer)
+{
+	foley_input_->set_selected_layer(layer);
+	display_layer_controls();
+
+	show_samples_selector();
+	sample_selector_.show_selection();
+}
+
+void SampleManager::display_layer_controls()
+{
+	const int layer = foley_input_->get_selected_layer();
+
+	layer_buttons_[static_cast<size_t>(layer)].setToggleState(true, dontSendNotification);
+	layer_routing_.setSelectedId(foley_input_->get_layer_routing(layer) + 1, dontSendNotification);
+	layer_gain_.setValue(foley_input_->get_layer_gain(layer), dontSendNotification);
+}
+
 void SampleManager::display_library_name()
 {
 	library_name.setText(foley_input_->get_current_library_name(), dontSendNotification);
@@ -51,6 +136,7 @@ void SampleManager::setup_selector_name_label()
 //==============================================================================
 SampleManager::~SampleManager()
 {
+	foley_input_->removeChangeListener(this);
 }
 
 void SampleManager::paint(juce::Graphics& g)
@@ -71,8 +157,17 @@ void SampleManager::resized()
 	auto info_bar = rectangle.removeFromTop(30);
 	library_name.setBounds(info_bar.removeFromLeft(75));
 	load_library_.setBounds(info_bar.removeFromRight(75).reduced(delta));
+	granular_.setBounds(info_bar.removeFromRight(60).reduced(delta));
 	selector_name.setBounds(info_bar);
 
+	auto layer_bar = rectangle.removeFromTop(30);
+	for (auto& layer_button : layer_buttons_)
+	{
+		layer_button.setBounds(layer_bar.removeFromLeft(70).reduced(delta));
+	}
+	layer_routing_.setBounds(layer_bar.removeFromLeft(110).reduced(delta));
+	layer_gain_.setBounds(layer_bar.reduced(delta));
+
 	set_child_selector_bounds(rectangle);
 }
 
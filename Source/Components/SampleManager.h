@@ -8,7 +8,8 @@
 //==============================================================================
 /*
 */
-class SampleManager  : public juce::Component
+class SampleManager  : public juce::Component,
+                       private juce::ChangeListener
 {
 public:
 	void setup_library_name_label();
@@ -21,9 +22,14 @@ public:
 //==============================================================================
     void set_child_selector_bounds(const Rectangle<int>& rectangle) const;
 	void setup_load_library_button();
+	void setup_granular_button();
+	void setup_layer_controls();
 	void display_library_name();
 
 private:
+	// Called whenever FoleyInput publishes a new library list.
+	void changeListenerCallback(ChangeBroadcaster* source) override;
+//==============================================================================
     FoleyInput* foley_input_;
 
 	SampleSelector sample_selector_;
@@ -35,11 +41,19 @@ private:
 	void show_samples_selector();
 	void show_libraries_selector();
 	void set_visible_selector(SelectorComponent* new_visible_component);
+	// The sample grid, routing and gain then act on that layer.
+	void select_layer(int layer);
+	void display_layer_controls();
 
 //==============================================================================
 	Label library_name{"", ""};
 	Label selector_name{"", ""};
 	TextButton load_library_{"load_library"};
+	TextButton granular_{"granular"};
+
+	std::array<TextButton, FoleyInput::max_layers> layer_buttons_;
+	ComboBox layer_routing_{"layer_routing"};
+	Slider layer_gain_{Slider::LinearHorizontal, Slider::NoTextBox};
 //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleManager)
 };
@@ -5,58 +5,132 @@
 //==============================================================================
 SampleSelector::SampleSelector(FoleyInput* foley_input): foley_input_(foley_input)
 {
-	SampleSelector::create_element_components();
+	list_box_.setModel(this);
+	list_box_.setRowHeight(row_height);
+	list_box_.setColour(ListBox::backgroundColourId, Colours::transparentBlack);
+	addAndMakeVisible(list_box_);
+
 	enable_default_element();
 }
 
 SampleSelector::~SampleSelector()
 {
+	list_box_.setModel(nullptr);
 }
 
 void SampleSelector::enable_default_element()
 {
-	if (!element_components_.empty())
+	if (foley_input_->get_number_of_samples() > 0)
 	{
-		element_clicked(element_components_.at(0).get());
+		select_sample(0);
 	}
 }
 
 void SampleSelector::reload_samples()
 {
-	element_components_.clear();
-	SampleSelector::create_element_components();
-	resized();
-	enable_default_element();
+	list_box_.updateContent();
+
+	if (foley_input_->get_selected_sample_index() < 0)
+	{
+		enable_default_element();
+	}
+	list_box_.repaint();
+}
+
+void SampleSelector::show_selection()
+{
+	list_box_.updateContent();
+	list_box_.repaint();
+}
+
+void SampleSelector::resized()
+{
+	list_box_.setBounds(getLocalBounds().reduced(1));
 }
 
 
 void SampleSelector::element_clicked(SelectorElement* clicked_element)
 {
-	for (auto& sample_component : element_components_)
-	{
-		if (static_cast<Button*>(sample_component.get()) != clicked_element)
-		{
-			sample_component->unselect();
-		}
-	}
-	clicked_element->select();
+	select_sample(static_cast<SampleComponent*>(clicked_element)->sample_index);
+}
+
+void SampleSelector::select_sample(const int sample_index)
+{
+	foley_input_->set_selected_sample(sample_index);
+
+	// Visible rows re-read the selection; rows out of view will when scrolled in.
+	list_box_.updateContent();
+}
+
+//==============================================================================
+int SampleSelector::getNumRows()
+{
+	return (foley_input_->get_number_of_samples() + components_per_row - 1) / components_per_row;
+}
 
-	foley_input_->set_selected_sample(
-		static_cast<SampleComponent*>(clicked_element)->file_audio_source->audio_source.get());
+void SampleSelector::paintListBoxItem(int, Graphics&, int, int, bool)
+{
 }
 
-void SampleSelector::create_element_components()
+Component* SampleSelector::refreshComponentForRow(const int rowNumber, bool, Component* existingComponentToUpdate)
 {
-	for (const auto& sample : foley_input_->files_audio_sources)
+	auto* row = static_cast<SampleRow*>(existingComponentToUpdate);
+	if (row == nullptr)
 	{
-		element_components_.emplace_back(std::make_unique<SampleComponent>(sample.get()));
+		row = new SampleRow(*this);
 	}
-	for (auto& component : element_components_)
+	row->update(rowNumber);
+	return row;
+}
+
+//==============================================================================
+SampleSelector::SampleRow::SampleRow(SampleSelector& owner): owner_(owner)
+{
+	for (auto& cell : cells_)
 	{
-		addAndMakeVisible(component.get());
-		component->onClick = [this, &component]()
+		addChildComponent(cell);
+		cell.onClick = [this, &cell]()
 		{
-			element_clicked(component.get());
+			owner_.element_clicked(&cell);
 		};
 	}
 }
+
+void SampleSelector::SampleRow::update(const int row_number)
+{
+	const auto* foley_input = owner_.foley_input_;
+
+	for (int column_index = 0; column_index < components_per_row; ++column_index)
+	{
+		auto& cell = cells_[static_cast<size_t>(column_index)];
+		const int sample_index = row_number * components_per_row + column_index;
+		const bool has_sample = row_number >= 0 && sample_index < foley_input->get_number_of_samples();
+
+		cell.setVisible(has_sample);
+		if (! has_sample)
+		{
+			continue;
+		}
+
+		cell.set_sample(sample_index, foley_input->get_sample(sample_index).file.getFileNameWithoutExtension());
+		if (sample_index == foley_input->get_selected_sample_index())
+		{
+			cell.select();
+		}
+		else
+		{
+			cell.unselect();
+		}
+	}
+}
+
+void SampleSelector::SampleRow::resized()
+{
+	auto rectangle = getLocalBounds();
+	const int component_width = rectangle.getWidth() / components_per_row;
+
+	for (auto& cell : cells_)
+	{
+		cell.setBounds(rectangle.removeFromLeft(component_width).reduced(delta));
+	}
+}
@@ -7,8 +7,11 @@
 
 //==============================================================================
 /*
+	Libraries can hold thousands of samples, so the grid is a ListBox: only the rows
+	in view have components, and they are recycled while scrolling.
 */
-class SampleSelector : public SelectorComponent
+class SampleSelector : public SelectorComponent,
+                       private ListBoxModel
 {
 public:
 	SampleSelector(FoleyInput* foley_input);
@@ -16,12 +19,42 @@ public:
 	void enable_default_element();
 
 	void reload_samples();
+	// Highlights the selected layer's sample again, without selecting a default one.
+	void show_selection();
+
+	void resized() override;
 private:
 	void element_clicked(SelectorElement*) override ;
-	void create_element_components() override;
+	void select_sample(int sample_index);
+
+	int getNumRows() override;
+	void paintListBoxItem(int rowNumber, Graphics& g, int width, int height, bool rowIsSelected) override;
+	Component* refreshComponentForRow(int rowNumber, bool isRowSelected, Component* existingComponentToUpdate) override;
+
+	//==============================================================================
+	class SampleRow : public Component
+	{
+	public:
+		explicit SampleRow(SampleSelector& owner);
+
+		void update(int row_number);
+		void resized() override;
+
+	private:
+		SampleSelector& owner_;
+		std::array<SampleComponent, 4> cells_;
+	};
+
+	enum
+	{
+		components_per_row = 4,
+		row_height = 40,
+		delta = 4
+	};
 
 //==============================================================================
 	FoleyInput* foley_input_;
+	ListBox list_box_;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleSelector)
 };
@@ -0,0 +1,201 @@
+#include "SampleVoice.h"
+
+SampleVoice::ReclaimThread::ReclaimThread(): TimeSliceThread("Foley sample reclaim")
+{
+	startThread(2);
+}
+
+SampleVoice::ReclaimThread::~ReclaimThread()
+{
+	stopThread(1000);
+}
+
+//==============================================================================
+SampleVoice::SampleVoice()
+{
+	for (int index = 0; index <= fade_table_size; ++index)
+	{
+		fade_table_[static_cast<size_t>(index)] = std::sin(MathConstants<float>::halfPi * index / fade_table_size);
+	}
+	reclaim_thread_->addTimeSliceClient(this);
+}
+
+SampleVoice::~SampleVoice()
+{
+	reclaim_thread_->removeTimeSliceClient(this);
+}
+
+void SampleVoice::prepare(const double sample_rate, const int maximum_block_size)
+{
+	sample_rate_ = (sample_rate > 0.) ? sample_rate : 44100.;
+	outgoing_buffer_.setSize(2, jmax(1, maximum_block_size));
+
+	retire(outgoing_source_);
+	outgoing_source_ = nullptr;
+	fade_length_ = 0;
+}
+
+void SampleVoice::process(AudioBuffer<float>& buffer)
+{
+	// Sources posted during a fade wait for it to end, so at most two play at once.
+	if (fade_length_ == 0)
+	{
+		apply_pending_sources();
+	}
+
+	if (current_source_ != nullptr)
+	{
+		current_source_->getNextAudioBlock(AudioSourceChannelInfo(buffer));
+	}
+	else
+	{
+		buffer.clear();
+	}
+
+	if (fade_length_ > 0)
+	{
+		crossfade(buffer);
+	}
+}
+
+bool SampleVoice::is_idle() const noexcept
+{
+	return current_source_ == nullptr && fade_length_ == 0 && command_fifo_.getNumReady() == 0;
+}
+
+bool SampleVoice::post_source(AudioSource* source)
+{
+	int start1, size1, start2, size2;
+	command_fifo_.prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 == 0)
+	{
+		return false;
+	}
+
+	commands_[static_cast<size_t>(start1)] = source;
+	command_fifo_.finishedWrite(1);
+	return true;
+}
+
+void SampleVoice::set_crossfade_length(const double crossfade_length_in_seconds)
+{
+	crossfade_length_in_seconds_.store(jmax(0., crossfade_length_in_seconds));
+}
+
+//==============================================================================
+int SampleVoice::useTimeSlice()
+{
+	int start1, size1, start2, size2;
+	retired_fifo_.prepareToRead(retired_fifo_.getNumReady(), start1, size1, start2, size2);
+
+	for (int index = 0; index < size1 + size2; ++index)
+	{
+		auto* source = retired_sources_[static_cast<size_t>(index < size1 ? start1 + index : start2 + index - size1)];
+		if (on_source_retired != nullptr)
+		{
+			on_source_retired(source);
+		}
+	}
+	retired_fifo_.finishedRead(size1 + size2);
+
+	return 20;
+}
+
+void SampleVoice::retire(AudioSource* source)
+{
+	if (source == nullptr)
+	{
+		return;
+	}
+
+	int start1, size1, start2, size2;
+	retired_fifo_.prepareToWrite(1, start1, size1, start2, size2);
+
+	// Sized well past the commands in flight; a full FIFO would only leak the source.
+	jassert(size1 == 1);
+	if (size1 == 1)
+	{
+		retired_sources_[static_cast<size_t>(start1)] = source;
+		retired_fifo_.finishedWrite(1);
+	}
+}
+
+void SampleVoice::apply_pending_sources()
+{
+	const int number_of_commands = command_fifo_.getNumReady();
+	if (number_of_commands == 0)
+	{
+		return;
+	}
+
+	int start1, size1, start2, size2;
+	command_fifo_.prepareToRead(number_of_commands, start1, size1, start2, size2);
+
+	// Only the latest source is played; the ones it supersedes are retired unplayed.
+	AudioSource* next_source = nullptr;
+	for (int index = 0; index < size1 + size2; ++index)
+	{
+		if (index > 0)
+		{
+			retire(next_source);
+		}
+		next_source = commands_[static_cast<size_t>(index < size1 ? start1 + index : start2 + index - size1)];
+	}
+	command_fifo_.finishedRead(size1 + size2);
+
+	if (next_source == current_source_)
+	{
+		retire(next_source);
+		return;
+	}
+
+	outgoing_source_ = current_source_;
+	current_source_ = next_source;
+	fade_position_ = 0;
+	fade_length_ = jmax(1, roundToInt(crossfade_length_in_seconds_.load() * sample_rate_));
+}
+
+void SampleVoice::crossfade(AudioBuffer<float>& buffer)
+{
+	const int number_of_samples = buffer.getNumSamples();
+	const int number_of_channels = jmin(buffer.getNumChannels(), outgoing_buffer_.getNumChannels());
+	const bool can_render_outgoing = outgoing_source_ != nullptr && number_of_samples <= outgoing_buffer_.getNumSamples();
+
+	jassert(number_of_samples <= outgoing_buffer_.getNumSamples());
+
+	if (can_render_outgoing)
+	{
+		outgoing_source_->getNextAudioBlock(AudioSourceChannelInfo(&outgoing_buffer_, 0, number_of_samples));
+	}
+
+	const int fade_samples = jmin(number_of_samples, fade_length_ - fade_position_);
+
+	for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+	{
+		auto* incoming = buffer.getWritePointer(channel);
+		const auto* outgoing = outgoing_buffer_.getReadPointer(jmin(channel, number_of_channels - 1));
+
+		for (int sample = 0; sample < fade_samples; ++sample)
+		{
+			const int table_index = static_cast<int>(static_cast<int64>(fade_position_ + sample) * fade_table_size
+				/ fade_length_);
+			const float incoming_gain = fade_table_[static_cast<size_t>(table_index)];
+			const float outgoing_gain = fade_table_[static_cast<size_t>(fade_table_size - table_index)];
+
+			incoming[sample] *= incoming_gain;
+			if (can_render_outgoing)
+			{
+				incoming[sample] += outgoing[sample] * outgoing_gain;
+			}
+		}
+	}
+
+	fade_position_ += fade_samples;
+	if (fade_position_ >= fade_length_)
+	{
+		retire(outgoing_source_);
+		outgoing_source_ = nullptr;
+		fade_length_ = 0;
+	}
+}
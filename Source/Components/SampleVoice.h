@@ -0,0 +1,79 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Plays the selected foley source, switching between sources on the audio thread
+	itself. The message thread only posts the next source through a lock-free FIFO;
+	the audio thread picks it up between blocks and crossfades to it with equal
+	power, so switching neither races nor clicks. A source it stops using, faded out
+	or superseded before it ever played, goes through a second FIFO to a shared
+	reclaim thread, which hands it to on_source_retired. Nothing is released or
+	freed on the audio thread.
+*/
+class SampleVoice : private TimeSliceClient
+{
+public:
+	// Kept apart from the read-ahead thread, which releasing a source has to wait for.
+	class ReclaimThread : public TimeSliceThread
+	{
+	public:
+		ReclaimThread();
+		~ReclaimThread() override;
+	};
+
+	//==============================================================================
+	SampleVoice();
+	~SampleVoice() override;
+
+	// Not concurrent with process(): a fade in progress is cut short.
+	void prepare(double sample_rate, int maximum_block_size);
+	void process(AudioBuffer<float>& buffer);
+	// Audio thread only: true when nothing plays, fades or waits to be picked up.
+	bool is_idle() const noexcept;
+
+	// A null source fades out to silence. False if the FIFO is full: nothing was posted.
+	bool post_source(AudioSource* source);
+	void set_crossfade_length(double crossfade_length_in_seconds);
+
+	// Called on the reclaim thread, once per source posted.
+	std::function<void(AudioSource*)> on_source_retired;
+
+private:
+	int useTimeSlice() override;
+	void retire(AudioSource* source);
+	void apply_pending_sources();
+	void crossfade(AudioBuffer<float>& buffer);
+	//==============================================================================
+	enum
+	{
+		command_fifo_size = 32,
+		retired_fifo_size = 128,
+		fade_table_size = 1024
+	};
+
+	AbstractFifo command_fifo_{command_fifo_size};
+	std::array<AudioSource*, command_fifo_size> commands_{};
+
+	AbstractFifo retired_fifo_{retired_fifo_size};
+	std::array<AudioSource*, retired_fifo_size> retired_sources_{};
+
+	// Only touched by the audio thread, or by prepare() while it is stopped.
+	AudioSource* current_source_ = nullptr;
+	AudioSource* outgoing_source_ = nullptr;
+	int fade_position_ = 0;
+	int fade_length_ = 0;
+
+	AudioBuffer<float> outgoing_buffer_;
+	// Quarter sine: the incoming gain, read backwards for the outgoing one.
+	std::array<float, fade_table_size + 1> fade_table_{};
+
+	std::atomic<double> crossfade_length_in_seconds_{0.05};
+	double sample_rate_ = 44100.;
+
+	SharedResourcePointer<ReclaimThread> reclaim_thread_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleVoice)
+};
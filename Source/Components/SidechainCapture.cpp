@@ -0,0 +1,166 @@
+#include "SidechainCapture.h"
+
+SidechainCapture::SidechainCapture()
+{
+}
+
+SidechainCapture::~SidechainCapture()
+{
+	stop();
+	writer_thread_.stopThread(1000);
+}
+
+void SidechainCapture::prepare(const double sample_rate, const int sidechain_channels, const int output_channels)
+{
+	// A file cannot change format halfway through, so a new layout ends the take.
+	if (sample_rate != sample_rate_
+		|| sidechain_channels != number_of_channels_[SIDECHAIN]
+		|| output_channels != number_of_channels_[OUTPUT])
+	{
+		stop();
+	}
+
+	sample_rate_ = sample_rate;
+	number_of_channels_[SIDECHAIN] = sidechain_channels;
+	number_of_channels_[OUTPUT] = output_channels;
+}
+
+bool SidechainCapture::start(const File& directory, const bool capture_output)
+{
+	stop();
+
+	if (sample_rate_ <= 0. || number_of_channels_[SIDECHAIN] <= 0 || ! directory.createDirectory())
+	{
+		return false;
+	}
+
+	const String take_name = Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
+	files_.fill(File());
+
+	if (! open(SIDECHAIN, directory.getNonexistentChildFile("sidechain_" + take_name, ".wav")))
+	{
+		return false;
+	}
+	if (capture_output && number_of_channels_[OUTPUT] > 0)
+	{
+		open(OUTPUT, directory.getNonexistentChildFile("output_" + take_name, ".wav"));
+	}
+
+	if (! writer_thread_.isThreadRunning())
+	{
+		writer_thread_.startThread();
+	}
+
+	dropped_blocks_.store(0);
+	{
+		const SpinLock::ScopedLockType lock(writers_lock_);
+		for (int index = 0; index < NUMBER_OF_STREAMS; ++index)
+		{
+			active_writers_[index] = writers_[index].get();
+		}
+	}
+	is_capturing_.store(true);
+	return true;
+}
+
+void SidechainCapture::stop()
+{
+	{
+		const SpinLock::ScopedLockType lock(writers_lock_);
+		active_writers_.fill(nullptr);
+	}
+	is_capturing_.store(false);
+
+	// Deleting a ThreadedWriter flushes what is left in its FIFO and closes the file.
+	for (auto& writer : writers_)
+	{
+		writer.reset();
+	}
+}
+
+void SidechainCapture::write(const stream stream, const AudioBuffer<float>& buffer) noexcept
+{
+	const SpinLock::ScopedTryLockType lock(writers_lock_);
+
+	if (! lock.isLocked())
+	{
+		if (is_capturing_.load(std::memory_order_relaxed))
+		{
+			++dropped_blocks_;
+		}
+		return;
+	}
+
+	auto* writer = active_writers_[stream];
+
+	if (writer == nullptr)
+	{
+		return;
+	}
+
+	if (buffer.getNumChannels() < number_of_channels_[stream]
+		|| ! writer->write(buffer.getArrayOfReadPointers(), buffer.getNumSamples()))
+	{
+		++dropped_blocks_;
+	}
+}
+
+//==============================================================================
+bool SidechainCapture::is_capturing() const noexcept
+{
+	return is_capturing_.load();
+}
+
+int SidechainCapture::get_number_of_dropped_blocks() const noexcept
+{
+	return dropped_blocks_.load();
+}
+
+File SidechainCapture::get_file(const stream stream) const
+{
+	return files_[stream];
+}
+
+std::unique_ptr<MemoryMappedAudioFormatReader> SidechainCapture::create_memory_mapped_reader(const File& file)
+{
+	WavAudioFormat wav_format;
+	std::unique_ptr<MemoryMappedAudioFormatReader> reader(wav_format.createMemoryMappedReader(file));
+
+	if (reader == nullptr || ! reader->mapEntireFile())
+	{
+		return nullptr;
+	}
+	return reader;
+}
+
+File SidechainCapture::get_default_directory()
+{
+	return File::getSpecialLocation(File::userMusicDirectory).getChildFile("Whoosh Generator Captures");
+}
+
+//==============================================================================
+bool SidechainCapture::open(const stream stream, const File& file)
+{
+	auto output_stream = std::make_unique<FileOutputStream>(file);
+
+	if (! output_stream->openedOk())
+	{
+		return false;
+	}
+
+	// WAV rather than W64: JUCE has no W64 writer, switches to RF64 past 4 GB, and can memory-map it back.
+	WavAudioFormat wav_format;
+	auto* writer = wav_format.createWriterFor(output_stream.get(), sample_rate_,
+	                                          static_cast<unsigned int>(number_of_channels_[stream]),
+	                                          bits_per_sample, {}, 0);
+	if (writer == nullptr)
+	{
+		return false;
+	}
+	output_stream.release();
+
+	writers_[stream] = std::make_unique<AudioFormatWriter::ThreadedWriter>(
+		writer, writer_thread_, roundToInt(sample_rate_ * fifo_length_in_seconds));
+	files_[stream] = file;
+	return true;
+}
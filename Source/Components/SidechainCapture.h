@@ -0,0 +1,66 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Streams the sidechain, and optionally the processed output, to WAV files while
+	the plugin runs. The audio thread only pushes blocks into the FIFO of an
+	AudioFormatWriter::ThreadedWriter; all disk access happens on a background
+	TimeSliceThread. Writers are swapped under a SpinLock that the audio thread only
+	ever try-locks, and blocks that cannot be queued are counted, never waited for.
+	Finished takes are read back memory-mapped, as the offline render does, so an
+	hour-long take costs address space rather than RAM or reads.
+*/
+class SidechainCapture
+{
+public:
+	enum stream
+	{
+		SIDECHAIN,
+		OUTPUT,
+
+		NUMBER_OF_STREAMS
+	};
+
+	enum
+	{
+		bits_per_sample = 24,
+		fifo_length_in_seconds = 10
+	};
+
+	SidechainCapture();
+	~SidechainCapture();
+
+	void prepare(double sample_rate, int sidechain_channels, int output_channels);
+	bool start(const File& directory, bool capture_output);
+	void stop();
+
+	void write(stream stream, const AudioBuffer<float>& buffer) noexcept;
+	//==============================================================================
+	bool is_capturing() const noexcept;
+	int get_number_of_dropped_blocks() const noexcept;
+	File get_file(stream stream) const;
+
+	// Null when the file is not a WAV or cannot be mapped.
+	static std::unique_ptr<MemoryMappedAudioFormatReader> create_memory_mapped_reader(const File& file);
+	static File get_default_directory();
+
+private:
+	bool open(stream stream, const File& file);
+	//==============================================================================
+	TimeSliceThread writer_thread_{"Sidechain Capture"};
+
+	std::array<std::unique_ptr<AudioFormatWriter::ThreadedWriter>, NUMBER_OF_STREAMS> writers_;
+	std::array<AudioFormatWriter::ThreadedWriter*, NUMBER_OF_STREAMS> active_writers_{};
+	std::array<int, NUMBER_OF_STREAMS> number_of_channels_{};
+	std::array<File, NUMBER_OF_STREAMS> files_;
+	double sample_rate_ = 0.;
+
+	SpinLock writers_lock_;
+	std::atomic<bool> is_capturing_{false};
+	std::atomic<int> dropped_blocks_{0};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SidechainCapture)
+};
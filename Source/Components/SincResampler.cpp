@@ -0,0 +1,204 @@
+#include "SincResampler.h"
+#include <numeric>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+SincResampler::SincResampler(const double source_sample_rate, const double target_sample_rate,
+                             const int number_of_zero_crossings):
+	speed_ratio_(source_sample_rate / target_sample_rate)
+{
+	const int64 source_rate = roundToInt(source_sample_rate);
+	const int64 target_rate = roundToInt(target_sample_rate);
+
+	if (source_rate == source_sample_rate && target_rate == target_sample_rate && source_rate > 0 && target_rate > 0)
+	{
+		const int64 divisor = std::gcd(source_rate, target_rate);
+		if (target_rate / divisor <= max_phases)
+		{
+			is_rational_ = true;
+			source_step_ = source_rate / divisor;
+			number_of_phases_ = static_cast<int>(target_rate / divisor);
+		}
+	}
+
+	// Slightly under the lower Nyquist frequency, leaving room for the transition band.
+	const double cutoff = 0.95 * jmin(1., 1. / speed_ratio_);
+	half_width_ = static_cast<int>(std::ceil(number_of_zero_crossings / cutoff));
+	taps_per_phase_ = (2 * half_width_ + 3) & ~3;
+
+	fill_table(cutoff, 8.);
+}
+
+int SincResampler::get_output_length(const double source_sample_rate, const double target_sample_rate,
+                                     const int input_length)
+{
+	return static_cast<int>(std::ceil(input_length * target_sample_rate / source_sample_rate));
+}
+
+int SincResampler::get_number_of_complete_outputs(const int available_input_length) const
+{
+	// One sample of margin for the phase rounding of irrational ratios.
+	return jmax(0, static_cast<int>((available_input_length - half_width_ - 2) / speed_ratio_));
+}
+
+void SincResampler::process(const float* input, const int input_length, float* output, const int output_length) const
+{
+	process(input, input_length, output, 0, output_length);
+}
+
+void SincResampler::process(const float* input, const int input_length, float* output, const int first_output,
+                            const int number_of_outputs) const
+{
+	process_window(input, 0, input_length, output + first_output, first_output, number_of_outputs);
+}
+
+Range<int64> SincResampler::get_input_range(const int64 first_output, const int number_of_outputs) const
+{
+	if (number_of_outputs <= 0)
+	{
+		return {};
+	}
+
+	int64 first_input_index, last_input_index;
+	int phase;
+	locate(first_output, first_input_index, phase);
+	locate(first_output + number_of_outputs - 1, last_input_index, phase);
+
+	return {first_input_index - half_width_ + 1, last_input_index - half_width_ + 1 + taps_per_phase_};
+}
+
+void SincResampler::process_window(const float* input, const int64 input_start, const int input_length, float* output,
+                                   const int64 first_output, const int number_of_outputs) const
+{
+	for (int output_offset = 0; output_offset < number_of_outputs; ++output_offset)
+	{
+		int64 input_index;
+		int phase;
+		locate(first_output + output_offset, input_index, phase);
+
+		const float* coefficients = table_.data() + static_cast<size_t>(phase) * taps_per_phase_;
+		const int64 first_input = input_index - half_width_ + 1 - input_start;
+
+		if (first_input >= 0 && first_input + taps_per_phase_ <= input_length)
+		{
+			output[output_offset] = dot_product(coefficients, input + first_input, taps_per_phase_);
+			continue;
+		}
+
+		// Only the first and last few outputs reach past the input.
+		float sum = 0.f;
+		for (int tap = 0; tap < taps_per_phase_; ++tap)
+		{
+			const int64 index = first_input + tap;
+			if (index >= 0 && index < input_length)
+			{
+				sum += coefficients[tap] * input[index];
+			}
+		}
+		output[output_offset] = sum;
+	}
+}
+
+void SincResampler::locate(const int64 output_index, int64& input_index, int& phase) const noexcept
+{
+	if (is_rational_)
+	{
+		const int64 position = output_index * source_step_;
+		input_index = position / number_of_phases_;
+		phase = static_cast<int>(position % number_of_phases_);
+		return;
+	}
+
+	const double position = static_cast<double>(output_index) * speed_ratio_;
+	input_index = static_cast<int64>(position);
+	phase = roundToInt((position - static_cast<double>(input_index)) * number_of_phases_);
+
+	if (phase == number_of_phases_)
+	{
+		++input_index;
+		phase = 0;
+	}
+}
+
+//==============================================================================
+float SincResampler::dot_product(const float* a, const float* b, const int length) noexcept
+{
+#if JUCE_USE_SSE_INTRINSICS
+	__m128 sum = _mm_setzero_ps();
+	for (int index = 0; index < length; index += 4)
+	{
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + index), _mm_loadu_ps(b + index)));
+	}
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+#elif JUCE_USE_ARM_NEON
+	float32x4_t sum = vdupq_n_f32(0.f);
+	for (int index = 0; index < length; index += 4)
+	{
+		sum = vmlaq_f32(sum, vld1q_f32(a + index), vld1q_f32(b + index));
+	}
+	const float32x2_t pairs = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+	return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+#else
+	float sum = 0.f;
+	for (int index = 0; index < length; ++index)
+	{
+		sum += a[index] * b[index];
+	}
+	return sum;
+#endif
+}
+
+double SincResampler::bessel_i0(const double x)
+{
+	double sum = 1.;
+	double term = 1.;
+	for (int k = 1; k < 64 && term > sum * 1e-12; ++k)
+	{
+		term *= (x / (2. * k)) * (x / (2. * k));
+		sum += term;
+	}
+	return sum;
+}
+
+void SincResampler::fill_table(const double cutoff, const double beta)
+{
+	table_.assign(static_cast<size_t>(number_of_phases_) * taps_per_phase_, 0.f);
+	const double window_normalisation = 1. / bessel_i0(beta);
+
+	for (int phase = 0; phase < number_of_phases_; ++phase)
+	{
+		float* coefficients = table_.data() + static_cast<size_t>(phase) * taps_per_phase_;
+		const double fraction = static_cast<double>(phase) / number_of_phases_;
+		double sum = 0.;
+
+		for (int tap = 0; tap < 2 * half_width_; ++tap)
+		{
+			const double x = tap - half_width_ + 1 - fraction;
+			const double window_position = x / half_width_;
+			if (std::abs(window_position) >= 1.)
+			{
+				continue;
+			}
+
+			const double sinc = (x == 0.) ? 1. : std::sin(MathConstants<double>::pi * cutoff * x)
+				/ (MathConstants<double>::pi * cutoff * x);
+			const double window = bessel_i0(beta * std::sqrt(1. - window_position * window_position))
+				* window_normalisation;
+
+			coefficients[tap] = static_cast<float>(cutoff * sinc * window);
+			sum += coefficients[tap];
+		}
+
+		// Unity gain at DC for every phase, so no ripple at the phase rate.
+		for (int tap = 0; tap < taps_per_phase_; ++tap)
+		{
+			coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Offline windowed-sinc sample rate converter. The Kaiser-windowed low-pass is
+	tabulated once per phase: for the usual rates the ratio is rational with few
+	phases (44.1 -> 48 kHz needs 160), so every output sample is one exact dot
+	product, vectorised with SSE or NEON where JUCE enables them. Uncommon ratios
+	fall back to the nearest of max_phases phases. The cutoff follows the lower of
+	the two rates, so downsampling does not alias.
+*/
+class SincResampler
+{
+public:
+	SincResampler(double source_sample_rate, double target_sample_rate, int number_of_zero_crossings = 32);
+
+	static int get_output_length(double source_sample_rate, double target_sample_rate, int input_length);
+
+	// Input outside [0, input_length) is taken as silence.
+	void process(const float* input, int input_length, float* output, int output_length) const;
+	// Only writes output[first_output, first_output + number_of_outputs), for conversions done in chunks.
+	void process(const float* input, int input_length, float* output, int first_output, int number_of_outputs) const;
+
+	// How many outputs the first available_input_length input samples fully determine.
+	int get_number_of_complete_outputs(int available_input_length) const;
+
+	// For streamed conversions: the input samples that outputs [first_output, first_output + number_of_outputs)
+	// read. process_window() takes that window from input_start on and writes those outputs from output[0].
+	Range<int64> get_input_range(int64 first_output, int number_of_outputs) const;
+	void process_window(const float* input, int64 input_start, int input_length, float* output, int64 first_output,
+	                    int number_of_outputs) const;
+
+private:
+	void locate(int64 output_index, int64& input_index, int& phase) const noexcept;
+	static float dot_product(const float* a, const float* b, int length) noexcept;
+	static double bessel_i0(double x);
+	void fill_table(double cutoff, double beta);
+	//==============================================================================
+	enum
+	{
+		max_phases = 4096
+	};
+
+	const double speed_ratio_;
+
+	// Exact ratios advance by source_step_ / number_of_phases_ input samples per output.
+	bool is_rational_ = false;
+	int64 source_step_ = 0;
+	int number_of_phases_ = max_phases;
+
+	int half_width_ = 0;
+	// A multiple of four, so the dot product never needs a scalar tail.
+	int taps_per_phase_ = 0;
+	std::vector<float> table_;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SincResampler)
+};
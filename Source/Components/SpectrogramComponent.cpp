@@ -0,0 +1,141 @@
+#include "SpectrogramComponent.h"
+
+
+SpectrogramComponent::SpectrogramComponent(SpectrumAnalyzer* analyzer): analyzer(analyzer)
+{
+	setOpaque(true);
+
+	ColourGradient gradient(Colours::black, 0.f, 0.f, Colours::white, 1.f, 0.f, false);
+	gradient.addColour(0.35, Colour(20, 40, 130));
+	gradient.addColour(0.6, Colour(190, 40, 80));
+	gradient.addColour(0.85, Colour(250, 200, 40));
+
+	for (int index = 0; index < lut_size; ++index)
+	{
+		colour_lut_[index] = gradient.getColourAtPosition(index / static_cast<double>(lut_size - 1));
+	}
+	analyzer->add_frame_reader();
+}
+
+SpectrogramComponent::~SpectrogramComponent()
+{
+	analyzer->remove_frame_reader();
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g)
+{
+	if (! image_.isValid())
+	{
+		g.fillAll(Colours::black);
+		return;
+	}
+
+	// The column after the write position is the oldest one: draw it first, at the left edge.
+	const int width = image_.getWidth();
+	const int height = image_.getHeight();
+	const int oldest_column = (write_column_ + 1) % width;
+	const int oldest_part_width = width - oldest_column;
+
+	g.drawImage(image_, 0, 0, oldest_part_width, height, oldest_column, 0, oldest_part_width, height);
+	g.drawImage(image_, oldest_part_width, 0, oldest_column, height, 0, 0, oldest_column, height);
+}
+
+void SpectrogramComponent::resized()
+{
+	image_ = Image(Image::RGB, jmax(1, getWidth()), jmax(1, getHeight()), true);
+	write_column_ = 0;
+	update_row_map();
+}
+
+void SpectrogramComponent::refresh()
+{
+	if (analyzer->get_frequency_interval() != row_map_frequency_interval_)
+	{
+		update_row_map();
+	}
+
+	bool has_new_columns = false;
+	float peak_frequency = 0.f;
+
+	while (analyzer->pop_spectrogram_frame(magnitudes_.data(), peak_frequency))
+	{
+		write_column(peak_frequency);
+		has_new_columns = true;
+	}
+
+	if (has_new_columns)
+	{
+		repaint();
+	}
+}
+
+//==============================================================================
+void SpectrogramComponent::update_row_map()
+{
+	row_map_frequency_interval_ = analyzer->get_frequency_interval();
+
+	const int height = image_.getHeight();
+	row_to_bin_.resize(static_cast<size_t>(jmax(0, height)));
+
+	if (row_map_frequency_interval_ <= 0.)
+	{
+		std::fill(row_to_bin_.begin(), row_to_bin_.end(), 0);
+		return;
+	}
+
+	// Row 0 is the top of the image, at Nyquist.
+	const float max_frequency = static_cast<float>(row_map_frequency_interval_ * (SpectrumAnalyzer::number_of_bins - 1));
+	const float ratio = max_frequency / min_frequency_in_hz_;
+
+	for (int row = 0; row < height; ++row)
+	{
+		const float proportion = 1.f - (row + 0.5f) / static_cast<float>(height);
+		const float frequency = min_frequency_in_hz_ * std::pow(ratio, proportion);
+
+		row_to_bin_[static_cast<size_t>(row)] = jlimit(0, SpectrumAnalyzer::number_of_bins - 1,
+		                                               roundToInt(frequency / row_map_frequency_interval_));
+	}
+}
+
+void SpectrogramComponent::write_column(const float peak_frequency)
+{
+	const int width = image_.getWidth();
+	const int height = image_.getHeight();
+
+	write_column_ = (write_column_ + 1) % width;
+
+	const float normalisation = Decibels::gainToDecibels(static_cast<float>(SpectrumAnalyzer::fft_size));
+
+	Image::BitmapData bitmap(image_, write_column_, 0, 1, height, Image::BitmapData::writeOnly);
+
+	for (int row = 0; row < height; ++row)
+	{
+		const float level = Decibels::gainToDecibels(magnitudes_[row_to_bin_[static_cast<size_t>(row)]])
+			- normalisation;
+		const int index = roundToInt(jmap(jlimit(min_decibels_, max_decibels_, level),
+		                                   min_decibels_, max_decibels_, 0.f, static_cast<float>(lut_size - 1)));
+
+		bitmap.setPixelColour(0, row, colour_lut_[index]);
+	}
+
+	const int peak_row = frequency_to_row(peak_frequency);
+
+	if (isPositiveAndBelow(peak_row, height))
+	{
+		bitmap.setPixelColour(0, peak_row, peak_colour_);
+		bitmap.setPixelColour(0, jmin(height - 1, peak_row + 1), peak_colour_);
+	}
+}
+
+int SpectrogramComponent::frequency_to_row(const float frequency) const
+{
+	if (frequency < min_frequency_in_hz_ || row_map_frequency_interval_ <= 0.)
+	{
+		return -1;
+	}
+
+	const float max_frequency = static_cast<float>(row_map_frequency_interval_ * (SpectrumAnalyzer::number_of_bins - 1));
+	const float proportion = std::log(frequency / min_frequency_in_hz_) / std::log(max_frequency / min_frequency_in_hz_);
+
+	return roundToInt((1.f - proportion) * image_.getHeight() - 0.5f);
+}
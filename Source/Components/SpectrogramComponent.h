@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "SpectrumAnalyzer.h"
+#include "RefreshScheduler.h"
+
+//==============================================================================
+/*
+	Scrolling spectrogram of the analysed sidechain. Each STFT frame becomes one
+	column written into a ring-buffered image, coloured through a lookup table on
+	a log-frequency row map, with the tracked frequency marked in the same column.
+	Painting is two blits of the ring, whatever the history length.
+*/
+class SpectrogramComponent : public juce::Component,
+                             public RefreshScheduler::Client
+{
+public:
+	explicit SpectrogramComponent(SpectrumAnalyzer* analyzer);
+	~SpectrogramComponent() override;
+
+	//==============================================================================
+	void paint(juce::Graphics& g) override;
+	void resized() override;
+	//==============================================================================
+	void refresh() override;
+
+private:
+	void update_row_map();
+	void write_column(float peak_frequency);
+	int frequency_to_row(float frequency) const;
+	//==============================================================================
+	enum
+	{
+		lut_size = 256
+	};
+
+	SpectrumAnalyzer* analyzer;
+
+	Image image_;
+	int write_column_ = 0;
+
+	std::array<float, SpectrumAnalyzer::number_of_bins> magnitudes_{};
+	std::array<Colour, lut_size> colour_lut_;
+	std::vector<int> row_to_bin_;
+	double row_map_frequency_interval_ = 0.;
+
+	const float min_frequency_in_hz_ = 20.f;
+	const float min_decibels_ = -100.f;
+	const float max_decibels_ = 0.f;
+	Colour peak_colour_ = Colours::white;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramComponent)
+};
@@ -1,25 +1,43 @@
 #include "SpectrumAnalyzer.h"
 
-SpectrumAnalyzer::SpectrumAnalyzer(AudioParameterFloat* parameter, AudioProcessorValueTreeState* in_state):
+SpectrumAnalyzer::SpectrumAnalyzer(AudioParameterFloat* parameter, AudioProcessorValueTreeState* in_state,
+                                   ParametersSmoother* in_parameters_smoother):
 	forwardFFT(fft_order),
 	window(fft_size,
 	       juce::dsp::WindowingFunction<float>::hann),
-	Analyzer(parameter, in_state, util::FREQUENCY_PEAK)
-
+	Analyzer(parameter, in_state, in_parameters_smoother, util::FREQUENCY_PEAK),
+	threshold_range_(in_state->getParameterRange(parameters::threshold.id))
 {
 	scopeData.fill(0);
+	scope_fft_data_.fill(0);
+	spectrogram_frames_.assign(static_cast<size_t>(spectrogram_fifo_size) * number_of_bins, 0.f);
 }
 
 void SpectrumAnalyzer::getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill)
 {
-	if (bufferToFill.getNumChannels() > 0)
+	const int number_of_channels = bufferToFill.getNumChannels();
+
+	// The peak and the partials come from the bus: the FFT would only feed views nobody shows.
+	if (uses_bus_value() && number_of_frame_readers_.load(std::memory_order_relaxed) == 0)
 	{
-		for (int channel = 0; channel < bufferToFill.getNumChannels(); ++channel)
-		{
-			const auto* channelData = bufferToFill.getReadPointer(channel, 0);
+		fifoIndex = 0;
+		return;
+	}
 
-			for (auto i = 0; i < bufferToFill.getNumSamples(); ++i)
-				push_next_sample_into_fifo(channelData[i]);
+	if (number_of_channels > 0)
+	{
+		// Channels are mixed down so one frame covers one stretch of time.
+		const auto* const* channels_data = bufferToFill.getArrayOfReadPointers();
+		const float channel_gain = 1.f / static_cast<float>(number_of_channels);
+
+		for (auto i = 0; i < bufferToFill.getNumSamples(); ++i)
+		{
+			float sample = 0.f;
+			for (int channel = 0; channel < number_of_channels; ++channel)
+			{
+				sample += channels_data[channel][i];
+			}
+			push_next_sample_into_fifo(sample * channel_gain);
 		}
 	}
 }
@@ -27,18 +45,27 @@ void SpectrumAnalyzer::getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill)
 void SpectrumAnalyzer::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
 	sample_rate = sampleRate;
-	frequency_interval = (1. / fft_size) * sampleRate;
-	fft_upper_limit = fft_size / 2;
+	frequency_interval.store((1. / fft_size) * sampleRate, std::memory_order_relaxed);
+	fifoIndex = 0;
+
+	// One peak update per analysed frame, whatever the host block size.
+	frequency_smoother_.set_speed(get_speed());
+	frequency_smoother_.prepare(sampleRate, fft_size);
+
+	// A full-scale sine peaks at fft_size / 4 once the Hann window is applied.
+	partial_tracker_.prepare(get_frequency_interval(), 4.f / fft_size);
 }
 
-void SpectrumAnalyzer::calculate_spectrum()
+bool SpectrumAnalyzer::calculate_spectrum()
 {
-	if (nextFFTBlockReady)
+	bool has_changed = false;
+
+	if (scope_frame_ready_.load(std::memory_order_acquire))
 	{
-		calculate_next_frame_of_spectrum();
-		last_fft_peak = get_fft_peak();
-		nextFFTBlockReady = false;
+		has_changed = calculate_next_frame_of_spectrum();
+		scope_frame_ready_.store(false, std::memory_order_release);
 	}
+	return has_changed;
 }
 
 void SpectrumAnalyzer::add_current_spectrum_to_accumulator_buffer()
@@ -65,19 +92,86 @@ void SpectrumAnalyzer::push_next_sample_into_fifo(float sample) noexcept
 {
 	if (fifoIndex == fft_size)
 	{
-		if (! nextFFTBlockReady)
-		{
-			std::fill(fftData.begin(), fftData.end(), 0.0f);
-			std::copy(fifo.begin(), fifo.end(), fftData.begin());
-			nextFFTBlockReady = true;
-		}
-
+		process_frame();
 		fifoIndex = 0;
 	}
 
 	fifo[fifoIndex++] = sample;
 }
 
+void SpectrumAnalyzer::process_frame()
+{
+	std::fill(fftData.begin(), fftData.end(), 0.0f);
+	std::copy(fifo.begin(), fifo.end(), fftData.begin());
+
+	calculate_fft();
+	get_fft_peak();
+
+	if (min_and_max_in_bounds() && ! uses_bus_value())
+	{
+		partial_tracker_.process_frame(fftData.data(), min_frequency_fft_index,
+		                               jmin<int>(max_frequency_fft_index, fft_upper_limit), get_threshold());
+	}
+	publish_scope_frame();
+	push_spectrogram_frame();
+}
+
+void SpectrumAnalyzer::publish_scope_frame()
+{
+	// The message thread clears the flag once it has drawn the previous frame.
+	if (! scope_frame_ready_.load(std::memory_order_acquire))
+	{
+		std::copy(fftData.begin(), fftData.begin() + scope_fft_data_.size(), scope_fft_data_.begin());
+		scope_min_index_ = min_frequency_fft_index;
+		scope_max_index_ = max_frequency_fft_index;
+
+		scope_frame_ready_.store(true, std::memory_order_release);
+	}
+}
+
+void SpectrumAnalyzer::push_spectrogram_frame()
+{
+	int start1, size1, start2, size2;
+	spectrogram_fifo_.prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 > 0)
+	{
+		std::copy(fftData.begin(), fftData.begin() + number_of_bins,
+		          spectrogram_frames_.begin() + static_cast<size_t>(start1) * number_of_bins);
+		spectrogram_peaks_[start1] = last_fft_peak;
+
+		spectrogram_fifo_.finishedWrite(1);
+	}
+}
+
+bool SpectrumAnalyzer::pop_spectrogram_frame(float* magnitudes, float& peak_frequency)
+{
+	int start1, size1, start2, size2;
+	spectrogram_fifo_.prepareToRead(1, start1, size1, start2, size2);
+
+	if (size1 <= 0)
+	{
+		return false;
+	}
+
+	const auto* frame = spectrogram_frames_.data() + static_cast<size_t>(start1) * number_of_bins;
+	std::copy(frame, frame + number_of_bins, magnitudes);
+	peak_frequency = spectrogram_peaks_[start1];
+
+	spectrogram_fifo_.finishedRead(1);
+	return true;
+}
+
+void SpectrumAnalyzer::add_frame_reader() noexcept
+{
+	++number_of_frame_readers_;
+}
+
+void SpectrumAnalyzer::remove_frame_reader() noexcept
+{
+	--number_of_frame_readers_;
+}
+
 float SpectrumAnalyzer::get_level(const float mindB, const float maxdB, const int point)
 {
 	const auto skewed_proportion_x = 1.0f - std::exp(
@@ -88,29 +182,40 @@ float SpectrumAnalyzer::get_level(const float mindB, const float maxdB, const in
 
 	float level = 0;
 
-	if (fft_data_index >= min_frequency_fft_index && fft_data_index <= max_frequency_fft_index)
+	if (fft_data_index >= scope_min_index_ && fft_data_index <= scope_max_index_)
 	{
-		level = juce::jmap(juce::jlimit(mindB, maxdB, Decibels::gainToDecibels(fftData[fft_data_index])
+		level = juce::jmap(juce::jlimit(mindB, maxdB, Decibels::gainToDecibels(scope_fft_data_[fft_data_index])
 		                                - Decibels::gainToDecibels(static_cast<float>(fft_size))),
 		                   mindB, maxdB, 0.0f, 1.0f);
 	}
 	return level;
 }
 
-void SpectrumAnalyzer::calculate_next_frame_of_spectrum()
+bool SpectrumAnalyzer::calculate_next_frame_of_spectrum()
 {
-	window.multiplyWithWindowingTable(&fftData[0], fft_size);
-
-	forwardFFT.performFrequencyOnlyForwardTransform(&fftData[0]);
-
 	const auto mindB = -100.0f;
 	const auto maxdB = 0.0f;
 
+	bool has_changed = false;
 
 	for (int point = 0; point < scope_size; ++point)
 	{
-		scopeData[point] = get_level(mindB, maxdB, point);
+		const float level = get_level(mindB, maxdB, point);
+		has_changed = has_changed || level != scopeData[point];
+		scopeData[point] = level;
 	}
+
+	// Every view compares against this, so a frame consumed by one editor still reaches the others.
+	if (has_changed)
+	{
+		++scope_generation_;
+	}
+	return has_changed;
+}
+
+uint32 SpectrumAnalyzer::get_scope_generation() const noexcept
+{
+	return scope_generation_;
 }
 
 int SpectrumAnalyzer::get_fft_mean_value()
@@ -129,35 +234,29 @@ int SpectrumAnalyzer::get_fft_mean_value()
 
 void SpectrumAnalyzer::calculate_fft()
 {
-	if (nextFFTBlockReady)
-	{
-		forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
-		nextFFTBlockReady = false;
-	}
+	window.multiplyWithWindowingTable(fftData.data(), fft_size);
+
+	forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
 }
 
-float SpectrumAnalyzer::calculate_variation(const int new_frequency_peak) const
+float SpectrumAnalyzer::get_speed() const
 {
-	const float variation_speed = in_parameters_state->getParameter(parameters::frequency_speed.id)->getValue();
-	return (new_frequency_peak - last_fft_peak) * variation_speed;
+	return in_parameters_smoother->get_block_end_value(parameters::FREQUENCY_SPEED);
+}
+
+float SpectrumAnalyzer::get_threshold() const
+{
+	return threshold_range_.convertTo0to1(in_parameters_smoother->get_block_end_value(parameters::THRESHOLD));
 }
 
 int SpectrumAnalyzer::get_min_frequency_fft_index() const
 {
-	const float min_frequency_fft_index_0to1 = in_parameters_state->getParameter(parameters::min_frequency.id)->
-	                                                                getValue();
-	return in_parameters_state->getParameterRange(parameters::min_frequency.id)
-	                          .convertFrom0to1(
-		                          min_frequency_fft_index_0to1);
+	return static_cast<int>(in_parameters_smoother->get_block_end_value(parameters::MIN_FREQUENCY));
 }
 
 int SpectrumAnalyzer::get_max_frequency_fft_index()
 {
-	const float max_frequency_fft_index_0to1 = in_parameters_state->getParameter(parameters::max_frequency.id)->
-	                                                                getValue();
-	return in_parameters_state->getParameterRange(parameters::max_frequency.id)
-	                          .convertFrom0to1(
-		                          max_frequency_fft_index_0to1);
+	return static_cast<int>(in_parameters_smoother->get_block_end_value(parameters::MAX_FREQUENCY));
 }
 
 bool SpectrumAnalyzer::min_and_max_in_bounds() const
@@ -175,37 +274,37 @@ int SpectrumAnalyzer::get_fft_peak()
 	jassert(
 		min_and_max_in_bounds());
 
+	if (! min_and_max_in_bounds() || min_frequency_fft_index == max_frequency_fft_index)
+	{
+		return roundToInt(last_fft_peak);
+	}
 
 	const auto max_iterator = std::max_element(fftData.begin() + min_frequency_fft_index,
 	                                           fftData.begin() + max_frequency_fft_index);
 
 	const auto max_index_iterator = fftData.begin() + max_frequency_fft_index;
 
-	if (max_iterator != max_index_iterator)
+	// Following the bus, the FFT only runs for the views; the peak is the publisher's.
+	if (max_iterator != max_index_iterator && ! uses_bus_value())
 	{
 		const float peak_amplitude = *max_iterator;
 
-		if (peak_amplitude >= in_parameters_state->getParameter(parameters::threshold.id)->getValue())
+		if (peak_amplitude >= get_threshold())
 		{
 			const auto index = std::distance(fftData.begin(), max_iterator);
 
-			const int new_frequency_peak = index * frequency_interval;
-
-			const int variation = calculate_variation(new_frequency_peak);
-
-			const int out_fft_peak = last_fft_peak + variation;
+			const float new_frequency_peak = static_cast<float>(index * get_frequency_interval());
 
-			last_fft_peak = out_fft_peak;
-
-			return out_fft_peak;
+			frequency_smoother_.set_speed(get_speed());
+			last_fft_peak = frequency_smoother_.process(new_frequency_peak, fft_size);
 		}
 	}
-	return last_fft_peak;
+	return roundToInt(last_fft_peak);
 }
 
 double SpectrumAnalyzer::get_frequency_interval() const
 {
-	return frequency_interval;
+	return frequency_interval.load(std::memory_order_relaxed);
 }
 
 float SpectrumAnalyzer::get_fft_index_upper_limit() const
@@ -213,11 +312,27 @@ float SpectrumAnalyzer::get_fft_index_upper_limit() const
 	return fft_upper_limit;
 }
 
+PartialTracker* SpectrumAnalyzer::get_partial_tracker()
+{
+	return &partial_tracker_;
+}
+
 float SpectrumAnalyzer::get_last_value() const
 {
 	return last_fft_peak;
 }
 
+void SpectrumAnalyzer::set_last_value(const float value)
+{
+	last_fft_peak = value;
+	frequency_smoother_.reset(value);
+}
+
+String SpectrumAnalyzer::get_name() const
+{
+	return "Spectrum";
+}
+
 String SpectrumAnalyzer::get_osc_address() const
 {
 	return "/frequency";
@@ -4,6 +4,8 @@
 
 
 #include "Analyzer.h"
+#include "VariationSmoother.h"
+#include "PartialTracker.h"
 
 using namespace juce;
 
@@ -12,21 +14,23 @@ class SpectrumAnalyzer : public ISpectrumAnalyzer,
 {
 public:
 
-	SpectrumAnalyzer(AudioParameterFloat* parameter, AudioProcessorValueTreeState* in_state);
+	SpectrumAnalyzer(AudioParameterFloat* parameter, AudioProcessorValueTreeState* in_state,
+	                 ParametersSmoother* in_parameters_smoother);
 
 	//==============================================================================
 	void getNextAudioBlock(juce::AudioBuffer<float>& bufferToFill) override;
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+	String get_name() const override;
 	//==============================================================================
-	void calculate_spectrum() override;
+	bool calculate_spectrum() override;
 	void add_current_spectrum_to_accumulator_buffer() override;
 	void calculate_mean_fft_data() override;
 	void push_next_sample_into_fifo(float sample) noexcept override;
 	float get_level(float mindB, float maxdB, int point);
-	void calculate_next_frame_of_spectrum() override;
+	bool calculate_next_frame_of_spectrum() override;
+	uint32 get_scope_generation() const noexcept;
 	int get_fft_mean_value() override;
 	void calculate_fft() override;
-	float calculate_variation(int new_frequency_peak) const;
 	int get_min_frequency_fft_index() const;
 	int get_max_frequency_fft_index();
 	int get_fft_peak() override;
@@ -35,9 +39,17 @@ public:
 	//Accessors
 	double get_frequency_interval() const;
 	float get_fft_index_upper_limit() const;
+	PartialTracker* get_partial_tracker();
+
+	// Message thread: pops the oldest analysed frame (number_of_bins magnitudes) and the peak tracked on it.
+	bool pop_spectrogram_frame(float* magnitudes, float& peak_frequency);
+	// Views reading frames register for their lifetime: following the bus without any, the FFT is skipped.
+	void add_frame_reader() noexcept;
+	void remove_frame_reader() noexcept;
 
 	//===============================================================================
 	float get_last_value() const override;
+	void set_last_value(float value) override;
 	String get_osc_address() const override;
 
 	//===============================================================================
@@ -45,12 +57,15 @@ public:
 	{
 		fft_order = 11,
 		fft_size = 1 << fft_order,
-		scope_size = 512
+		number_of_bins = fft_size / 2 + 1,
+		scope_size = 512,
+		spectrogram_fifo_size = 32
 	};
 
-	double sample_rate;
-	double frequency_interval;
-	float fft_upper_limit;
+	double sample_rate = 0.;
+	// Written by prepareToPlay, read by the views on the message thread; 0 until prepared.
+	std::atomic<double> frequency_interval{0.};
+	float fft_upper_limit = fft_size / 2;
 
 
 	std::array<float, scope_size>scopeData;
@@ -65,7 +80,19 @@ private:
 	std::array<float, fft_size> accumulator_buffer;
 
 	int fifoIndex = 0;
-	bool nextFFTBlockReady = false;
+
+	// Magnitudes handed from the audio thread to the message thread for the scope.
+	std::array<float, number_of_bins> scope_fft_data_;
+	int scope_min_index_ = 0;
+	int scope_max_index_ = 0;
+	std::atomic<bool> scope_frame_ready_{false};
+	uint32 scope_generation_ = 0;
+
+	// Every analysed frame, queued for the spectrogram; frames are dropped while the queue is full.
+	AbstractFifo spectrogram_fifo_{spectrogram_fifo_size};
+	std::vector<float> spectrogram_frames_;
+	std::array<float, spectrogram_fifo_size> spectrogram_peaks_{};
+	std::atomic<int> number_of_frame_readers_{0};
 
 
 	int block_index = 0;
@@ -73,11 +100,20 @@ private:
 	int fft_sum_ = 0;
 	int fft_index_ = 0;
 
-	int last_fft_peak = 0;
+	float last_fft_peak = 0.f;
 
 	int min_frequency_fft_index = 0;
 	int max_frequency_fft_index= 1000;
 
 	bool min_and_max_in_bounds() const;
+	void process_frame();
+	void publish_scope_frame();
+	void push_spectrogram_frame();
+	float get_speed() const;
+	float get_threshold() const;
 	juce::dsp::WindowingFunction<float> window;
+
+	NormalisableRange<float> threshold_range_;
+	VariationSmoother frequency_smoother_{VariationSmoother::CRITICALLY_DAMPED};
+	PartialTracker partial_tracker_;
 };
@@ -4,38 +4,72 @@
 SpectrumComponent::SpectrumComponent(SpectrumAnalyzer* analyzer): analyzer(analyzer)
 {
 	setOpaque(true);
-	startTimerHz(15);
+	path_.preallocateSpace(3 * SpectrumAnalyzer::scope_size + 1);
+	analyzer->add_frame_reader();
+}
+
+SpectrumComponent::~SpectrumComponent()
+{
+	analyzer->remove_frame_reader();
 }
 
 
 void SpectrumComponent::paint(juce::Graphics& g)
 {
+	// Only the dirty region is filled: JUCE clips paint() to what repaint() asked for.
 	g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
 
 	g.setOpacity(1.0f);
 	g.setColour(juce::Colours::white);
-	draw_frame(g);
+	g.strokePath(path_, PathStrokeType(1.0f));
 }
 
-void SpectrumComponent::timerCallback()
+void SpectrumComponent::resized()
 {
-	analyzer->calculate_spectrum();
+	const auto width = static_cast<float>(getWidth());
+
+	for (int point = 0; point < SpectrumAnalyzer::scope_size; ++point)
+	{
+		x_coordinates_[point] = juce::jmap(static_cast<float>(point), 0.0f,
+		                                   static_cast<float>(SpectrumAnalyzer::scope_size - 1), 0.0f, width);
+	}
+
+	update_path();
 	repaint();
 }
 
+void SpectrumComponent::refresh()
+{
+	analyzer->calculate_spectrum();
 
-void SpectrumComponent::draw_frame(juce::Graphics& g)
+	if (analyzer->get_scope_generation() == drawn_generation_)
+	{
+		return;
+	}
+
+	const auto previous_bounds = path_bounds_;
+	update_path();
+
+	repaint(previous_bounds.getUnion(path_bounds_).getSmallestIntegerContainer().expanded(2));
+}
+
+
+void SpectrumComponent::update_path()
 {
-	for (int i = 1; i < analyzer->scope_size; ++i)
+	const auto height = static_cast<float>(getHeight());
+
+	FloatVectorOperations::copyWithMultiply(y_coordinates_.data(), analyzer->scopeData.data(), -height,
+	                                        SpectrumAnalyzer::scope_size);
+	FloatVectorOperations::add(y_coordinates_.data(), height, SpectrumAnalyzer::scope_size);
+
+	path_.clear();
+	path_.startNewSubPath(x_coordinates_[0], y_coordinates_[0]);
+
+	for (int point = 1; point < SpectrumAnalyzer::scope_size; ++point)
 	{
-		const auto width = getLocalBounds().getWidth();
-		const auto height = getLocalBounds().getHeight();
-
-		g.drawLine({
-			(float)juce::jmap(i - 1, 0, analyzer->scope_size - 1, 0, width),
-			juce::jmap(analyzer->scopeData.at(i - 1), 0.0f, 1.0f, (float)height, 0.0f),
-			(float)juce::jmap(i, 0, analyzer->scope_size - 1, 0, width),
-			juce::jmap(analyzer->scopeData.at(i), 0.0f, 1.0f, (float)height, 0.0f)
-		});
+		path_.lineTo(x_coordinates_[point], y_coordinates_[point]);
 	}
+
+	path_bounds_ = path_.getBounds();
+	drawn_generation_ = analyzer->get_scope_generation();
 }
@@ -4,30 +4,38 @@
 
 #include "AudioChainElement.h"
 #include "SpectrumAnalyzer.h"
+#include "RefreshScheduler.h"
 
 //==============================================================================
 class SpectrumComponent : public juce::Component,
-                                  private juce::Timer
+                                  public RefreshScheduler::Client
 
 {
 public:
 	//! [constructor]
 	SpectrumComponent(SpectrumAnalyzer* analyzer);
 
-	~SpectrumComponent() override
-	{
-	}
+	~SpectrumComponent() override;
 
 	//==============================================================================
 	void paint(juce::Graphics& g) override;
+	void resized() override;
 	//==============================================================================
-	void timerCallback() override;
+	void refresh() override;
 	//==============================================================================
 	//==============================================================================
-	void draw_frame(juce::Graphics& g);
+	void update_path();
 	//==============================================================================
 private:
 
 	SpectrumAnalyzer* analyzer;
+
+	// x of every scope point, rebuilt on resize; y is scaled in one vector pass per frame.
+	std::array<float, SpectrumAnalyzer::scope_size> x_coordinates_{};
+	std::array<float, SpectrumAnalyzer::scope_size> y_coordinates_{};
+	Path path_;
+	Rectangle<float> path_bounds_;
+	uint32 drawn_generation_ = 0;
+
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumComponent)
 };
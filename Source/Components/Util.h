@@ -83,6 +83,20 @@ namespace util
 		return juce::jmax<float>(-100, decibels);
 	}
 
+	//===============//===============//===============//===============//===============//===============//===============//===============
+	// Maps a 0 to 1 variation speed to a smoothing time constant: 1 is immediate, 0 is 2 seconds.
+	inline float speed_to_time_constant_in_ms(const float speed)
+	{
+		const float slowest_time_constant_in_ms = 2000.f;
+		const float clamped_speed = juce::jlimit(0.f, 1.f, speed);
+
+		if (clamped_speed >= 1.f)
+		{
+			return 0.f;
+		}
+		return std::pow(slowest_time_constant_in_ms, 1.f - clamped_speed);
+	}
+
 	//===============//===============//===============//===============//===============//===============//===============//===============
 	enum parameter_type
 	{
@@ -93,7 +107,9 @@ namespace util
 		FREQUENCY_VARIATION_SPEED,
 		VOLUME_VARIATION_SPEED,
 		VOLUME,
-		FREQUENCY_PEAK
+		FREQUENCY_PEAK,
+		PARTIAL_FREQUENCY,
+		PARTIAL_AMPLITUDE
 	};
 }
 
@@ -0,0 +1,118 @@
+#include "VariationSmoother.h"
+#include "Util.h"
+
+VariationSmoother::VariationSmoother(const response response): response_(response)
+{
+}
+
+void VariationSmoother::prepare(const double sample_rate, const int samples_per_update)
+{
+	sample_rate_ = sample_rate;
+	update_coefficient(samples_per_update);
+}
+
+void VariationSmoother::set_time_constant(const float time_constant_in_ms) noexcept
+{
+	if (follows_speed_ || time_constant_in_ms != time_constant_in_ms_)
+	{
+		follows_speed_ = false;
+		time_constant_in_ms_ = time_constant_in_ms;
+		coefficient_ = calculate_coefficient(time_constant_in_ms_, coefficient_samples_per_update_);
+	}
+}
+
+void VariationSmoother::set_speed(const float speed) noexcept
+{
+	const float clamped_speed = jlimit(0.f, 1.f, speed);
+
+	if (! follows_speed_ || clamped_speed != speed_)
+	{
+		follows_speed_ = true;
+		speed_ = clamped_speed;
+		coefficient_ = get_speed_coefficient();
+	}
+}
+
+void VariationSmoother::reset(const float value) noexcept
+{
+	first_stage_ = value;
+	output_ = value;
+}
+
+float VariationSmoother::process(const float target, const int samples_since_last_update) noexcept
+{
+	// The coefficients hold for the prepared update size: only a block of another size pays for the exp().
+	const float coefficient = (samples_since_last_update == coefficient_samples_per_update_)
+		                          ? coefficient_
+		                          : calculate_coefficient(get_time_constant_in_ms(), samples_since_last_update);
+	const float gain = 1.f - coefficient;
+
+	if (response_ == CRITICALLY_DAMPED)
+	{
+		first_stage_ += (target - first_stage_) * gain;
+		output_ += (first_stage_ - output_) * gain;
+	}
+	else
+	{
+		output_ += (target - output_) * gain;
+	}
+	return output_;
+}
+
+float VariationSmoother::get_value() const noexcept
+{
+	return output_;
+}
+
+void VariationSmoother::update_coefficient(const int samples_per_update) noexcept
+{
+	coefficient_samples_per_update_ = samples_per_update;
+
+	// The last entry is the limit as the speed nears 1, 1 ms; a speed of exactly 1 stops smoothing.
+	for (int index = 0; index <= speed_table_size; ++index)
+	{
+		const float time_constant_in_ms = (index == speed_table_size)
+			                                  ? 1.f
+			                                  : util::speed_to_time_constant_in_ms(
+				                                  static_cast<float>(index) / speed_table_size);
+		speed_coefficients_[static_cast<size_t>(index)] = calculate_coefficient(time_constant_in_ms, samples_per_update);
+	}
+
+	coefficient_ = follows_speed_
+		               ? get_speed_coefficient()
+		               : calculate_coefficient(time_constant_in_ms_, samples_per_update);
+}
+
+float VariationSmoother::calculate_coefficient(const double time_constant_in_ms,
+                                               const int samples_per_update) const noexcept
+{
+	const double stage_time_constant_in_ms = (response_ == CRITICALLY_DAMPED)
+		                                         ? time_constant_in_ms * 0.5
+		                                         : time_constant_in_ms;
+	const double stage_time_constant_in_samples = stage_time_constant_in_ms * 0.001 * sample_rate_;
+
+	return (stage_time_constant_in_samples <= 0. || samples_per_update <= 0)
+		       ? 0.f
+		       : static_cast<float>(std::exp(-samples_per_update / stage_time_constant_in_samples));
+}
+
+double VariationSmoother::get_time_constant_in_ms() const noexcept
+{
+	return follows_speed_ ? util::speed_to_time_constant_in_ms(speed_) : time_constant_in_ms_;
+}
+
+float VariationSmoother::get_speed_coefficient() const noexcept
+{
+	if (speed_ >= 1.f)
+	{
+		return 0.f;
+	}
+
+	const float position = speed_ * speed_table_size;
+	const int index = jmin(static_cast<int>(position), speed_table_size - 1);
+	const float fraction = position - static_cast<float>(index);
+
+	return speed_coefficients_[static_cast<size_t>(index)]
+		+ (speed_coefficients_[static_cast<size_t>(index) + 1] - speed_coefficients_[static_cast<size_t>(index)])
+		* fraction;
+}
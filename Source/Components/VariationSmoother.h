@@ -0,0 +1,62 @@
+#pragma once
+#include <JuceHeader.h>
+
+using namespace juce;
+
+//==============================================================================
+/*
+	Follows the analyzers' raw measurements with a time constant expressed in
+	milliseconds. The coefficient depends on how many samples separate two updates,
+	so the same setting behaves identically whatever the block size or sample rate.
+	CRITICALLY_DAMPED cascades two one-pole stages, each with half the time constant.
+	A speed parameter is mapped through a table of coefficients built by prepare(), so
+	following an automated speed costs a lookup instead of a pow() and an exp().
+*/
+class VariationSmoother
+{
+public:
+	enum response
+	{
+		ONE_POLE,
+		CRITICALLY_DAMPED
+	};
+
+	explicit VariationSmoother(response response = ONE_POLE);
+	~VariationSmoother() = default;
+
+	void prepare(double sample_rate, int samples_per_update);
+	void set_time_constant(float time_constant_in_ms) noexcept;
+	// In [0, 1], as util::speed_to_time_constant_in_ms() maps it.
+	void set_speed(float speed) noexcept;
+	void reset(float value) noexcept;
+
+	float process(float target, int samples_since_last_update) noexcept;
+	float get_value() const noexcept;
+
+private:
+	void update_coefficient(int samples_per_update) noexcept;
+	float calculate_coefficient(double time_constant_in_ms, int samples_per_update) const noexcept;
+	float get_speed_coefficient() const noexcept;
+	double get_time_constant_in_ms() const noexcept;
+	//==============================================================================
+	enum
+	{
+		speed_table_size = 256
+	};
+
+	response response_;
+
+	double sample_rate_ = 44100.;
+	float time_constant_in_ms_ = 0.f;
+	float speed_ = -1.f;
+	bool follows_speed_ = false;
+
+	// Coefficients at evenly spaced speeds, for coefficient_samples_per_update_, the prepared size.
+	std::array<float, speed_table_size + 1> speed_coefficients_{};
+
+	int coefficient_samples_per_update_ = 0;
+	float coefficient_ = 0.f;
+
+	float first_stage_ = 0.f;
+	float output_ = 0.f;
+};
@@ -1,86 +1,64 @@
 #include "VolumeAnalyzer.h"
 
 
-VolumeAnalyzer::VolumeAnalyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state): Analyzer(
-	out_parameter, in_state, util::VOLUME)
+VolumeAnalyzer::VolumeAnalyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state,
+                               ParametersSmoother* in_parameters_smoother): Analyzer(
+	out_parameter, in_state, in_parameters_smoother, util::VOLUME)
 {
 }
 
 
 void VolumeAnalyzer::getNextAudioBlock(AudioBuffer<float>& bufferToFill)
 {
-	auto* threshold_parameter = in_parameters_state->getParameter(parameters::threshold.id);
-	const auto threshold_value_0_to_1 = threshold_parameter->getValue();
-	threshold_value = threshold_parameter->convertFrom0to1(threshold_value_0_to_1);
+	const int number_of_samples = bufferToFill.getNumSamples();
+	const int number_of_channels = bufferToFill.getNumChannels();
 
-	for (int channel = 0; channel < bufferToFill.getNumChannels(); ++channel)
+	if (number_of_samples <= 0 || number_of_channels <= 0 || uses_bus_value())
 	{
-		const auto* inputBuffer = bufferToFill.getReadPointer(
-			channel);
-
-		auto* outputBuffer = bufferToFill.getWritePointer(channel);
-
-		// apply_threshold_to_buffer(inputBuffer, outputBuffer);
-		accumulate_samples_squares(inputBuffer);
-
-		if (end_of_integration_period())
-		{
-			calculate_rms();
-			const float variation = calculate_variation();
-			last_rms_value = last_rms_value + variation;
-
-			samples_squares_sum = 0.0;
-			block_index = 0;
-		}
-		else
-		{
-			block_index++;
-		}
+		return;
 	}
+
+	threshold_value = in_parameters_smoother->get_block_end_value(parameters::THRESHOLD);
+
+	samples_squares_sum = 0.0;
+	for (int channel = 0; channel < number_of_channels; ++channel)
+	{
+		accumulate_samples_squares(bufferToFill.getReadPointer(channel), number_of_samples);
+	}
+	calculate_rms(number_of_samples * number_of_channels);
+
+	volume_smoother_.set_speed(get_speed());
+	last_rms_value = volume_smoother_.process(new_rms_value, number_of_samples);
 }
 
 void VolumeAnalyzer::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
 	sample_rate = sampleRate;
 	samples_per_block = samplesPerBlock;
-}
-
 
-void VolumeAnalyzer::apply_threshold_to_buffer(const float* inputBuffer, float* outputBuffer) const
-{
-	for (auto sample = 0; sample < samples_per_block; ++sample)
-	{
-		(last_rms_value >= threshold_value)
-			? outputBuffer[sample] = inputBuffer[sample]
-			: outputBuffer[sample] = 0;
-	}
+	volume_smoother_.set_speed(get_speed());
+	volume_smoother_.prepare(sampleRate, samplesPerBlock);
 }
 
-void VolumeAnalyzer::accumulate_samples_squares(const float* inputBuffer)
+
+void VolumeAnalyzer::accumulate_samples_squares(const float* inputBuffer, const int number_of_samples)
 {
-	for (auto sample = 0; sample < samples_per_block; ++sample)
+	for (auto sample = 0; sample < number_of_samples; ++sample)
 	{
 		samples_squares_sum += inputBuffer[sample] * inputBuffer[sample];
 	}
 }
 
-void VolumeAnalyzer::calculate_rms()
+void VolumeAnalyzer::calculate_rms(const int number_of_accumulated_samples)
 {
-	new_rms_value = sqrt(samples_squares_sum / samples_per_block);
+	new_rms_value = sqrt(samples_squares_sum / number_of_accumulated_samples);
 
 	new_rms_value = (new_rms_value < threshold_value) ? 0. : new_rms_value;
 }
 
-float VolumeAnalyzer::calculate_variation() const
+float VolumeAnalyzer::get_speed() const
 {
-	const float variation_speed = in_parameters_state->getParameter(parameters::volume_speed.id)->getValue();
-	return (new_rms_value - last_rms_value) * variation_speed;
-}
-
-bool VolumeAnalyzer::end_of_integration_period() const
-{
-	const int rms_blocks_length = 2 / sample_rate;
-	return block_index >= rms_blocks_length;
+	return in_parameters_smoother->get_block_end_value(parameters::VOLUME_SPEED);
 }
 
 float VolumeAnalyzer::get_last_rms_value_in_db() const
@@ -93,6 +71,17 @@ float VolumeAnalyzer::get_last_value() const
 	return last_rms_value;
 }
 
+void VolumeAnalyzer::set_last_value(const float value)
+{
+	last_rms_value = value;
+	volume_smoother_.reset(value);
+}
+
+String VolumeAnalyzer::get_name() const
+{
+	return "Volume";
+}
+
 String VolumeAnalyzer::get_osc_address() const
 {
 	return "/volume";
@@ -2,36 +2,37 @@
 #include <JuceHeader.h>
 
 #include "Analyzer.h"
+#include "VariationSmoother.h"
 
 using namespace juce;
 
 class VolumeAnalyzer :  public Analyzer
 {
 public:
-	VolumeAnalyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state);
+	VolumeAnalyzer(AudioParameterFloat* out_parameter, AudioProcessorValueTreeState* in_state,
+	               ParametersSmoother* in_parameters_smoother);
 	void getNextAudioBlock(AudioBuffer<float>& bufferToFill) override;
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+	String get_name() const override;
 	//=================================================================================================
 	float get_last_rms_value_in_db() const;
 	float get_last_value() const override;
+	void set_last_value(float value) override;
 	String get_osc_address() const override;
 
 private:
-	void apply_threshold_to_buffer(const float* inputBuffer, float* outputBuffer) const;
-	void accumulate_samples_squares(const float* inputBuffer);
-	void calculate_rms();
-	float calculate_variation() const;
-	bool end_of_integration_period() const;
+	void accumulate_samples_squares(const float* inputBuffer, int number_of_samples);
+	void calculate_rms(int number_of_accumulated_samples);
+	float get_speed() const;
 	//=================================================================================================
 	double sample_rate;
 	float last_rms_value = 1.0;
 	float samples_squares_sum = 0.0;
-	int block_index = 0;
-	float temp_previous_value = 0.;
-	bool is_rms_different = true;
 
 	float threshold_value = 0.;
 
-	float new_rms_value;
+	float new_rms_value = 0.;
 	int samples_per_block = 0;
+
+	VariationSmoother volume_smoother_{VariationSmoother::ONE_POLE};
 };
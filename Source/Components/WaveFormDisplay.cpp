@@ -2,17 +2,11 @@
 #include "WaveFormDisplay.h"
 
 //==============================================================================
-WaveFormDisplay::WaveFormDisplay():
-	thumbnailCache(2)
+WaveFormDisplay::WaveFormDisplay(const RecordingBuffer& recording_buffer, const double visible_length_in_seconds):
+	recording_buffer_(recording_buffer),
+	visible_length_in_seconds_(visible_length_in_seconds)
 {
-	formatManager.registerBasicFormats();
-	// transportPosition.setStart(0.0);
-
-	thumbnail_ = std::make_unique<AudioThumbnail>(source_samples_per_thumbnail_sample_, formatManager, thumbnailCache);
-
-	thumbnail_->addChangeListener(this);
-
-	startTimerHz(120);
+	setOpaque(true);
 }
 
 WaveFormDisplay::~WaveFormDisplay()
@@ -21,61 +15,110 @@ WaveFormDisplay::~WaveFormDisplay()
 
 void WaveFormDisplay::paint(juce::Graphics& g)
 {
-	if (thumbnail_->getTotalLength() > 0.0)
+	if (image_.isValid() && sample_rate_ > 0.)
 	{
-		g.setGradientFill(ColourGradient(Colour::fromRGBA(255, 255, 255, 255), topThumbArea.getX(),
-		                                 topThumbArea.getHeight() / 2, Colour::fromRGBA(255, 255, 255, 101),
-		                                 topThumbArea.getWidth(), topThumbArea.getHeight() / 2, false));
-
-		// if (transportPosition.getStart() < transportSource.getLengthInSeconds())
-		// {
-		// 	thumbnail_total_->drawChannel(g, topThumbArea.reduced(2),
-		// 	                             0.0, thumbnail_total_->getTotalLength(), 0, 1.0f);
-		//
-		// 	thumbnail_zoomed->drawChannel(g, bottomThumbArea.reduced(2),
-		// 	                              transportPosition.getStart(), transportPosition.getEnd(), 0, 1.0f);
-		// }
-		// else
-		// {
-		// 	thumbnail_total_->drawChannel(g, topThumbArea.reduced(2),
-		// 	                             0.0, thumbnail_total_->getTotalLength(), 0, 1.0f);
-		//
-		// 	thumbnail_zoomed->drawChannel(g, bottomThumbArea.reduced(2),
-		// 	                              transportPosition.getStart(), transportPosition.getEnd(), 0, 1.0f);
-		// }
+		g.drawImageAt(image_, 0, 0);
 	}
 	else
 	{
-		g.setColour(Colours::black);
-		g.setFont(28.0f);
-		g.drawFittedText("No audio file selected...", getLocalBounds(), Justification::centred, 2);
+		g.fillAll(background_colour_);
+		g.setColour(Colours::white);
+		g.setFont(14.0f);
+		g.drawFittedText("No sidechain signal...", getLocalBounds(), Justification::centred, 2);
 	}
 }
 
 void WaveFormDisplay::resized()
 {
-	auto r = getLocalBounds();
-	auto transportBounds = r.removeFromBottom(30);
-	int transportButtonWidth = transportBounds.getWidth() / 5;
-	int reduceAmount = 3;
+	const int width = jmax(1, getWidth());
+	const int height = jmax(1, getHeight());
 
-	bottomThumbArea = getLocalBounds();
-	topThumbArea = bottomThumbArea.removeFromTop(getLocalBounds().getHeight() / 2);
+	image_ = Image(Image::RGB, width, height, true);
+	columns_.resize(static_cast<size_t>(width));
+	needs_full_redraw_ = true;
 }
 
-void WaveFormDisplay::changeListenerCallback(ChangeBroadcaster* source)
+void WaveFormDisplay::refresh()
 {
-	if (source == thumbnail_.get())
+	const int width = image_.getWidth();
+	const double sample_rate = recording_buffer_.getSampleRate();
+
+	if (width <= 0 || sample_rate <= 0.)
+	{
+		return;
+	}
+
+	if (sample_rate != sample_rate_)
+	{
+		sample_rate_ = sample_rate;
+		needs_full_redraw_ = true;
+	}
+
+	const auto samples_per_column = jmax<int64>(1, roundToInt(visible_length_in_seconds_ * sample_rate_ / width));
+	const int64 column_index = recording_buffer_.get_write_position() / samples_per_column;
+
+	// A new layout or a ring that was prepared again starts from a blank image.
+	if (needs_full_redraw_ || samples_per_column != samples_per_column_ || column_index < last_column_index_)
+	{
+		samples_per_column_ = samples_per_column;
+		last_column_index_ = column_index - width;
+		needs_full_redraw_ = false;
+	}
+
+	const int64 number_of_new_columns = column_index - last_column_index_;
+
+	if (number_of_new_columns <= 0)
 	{
-		if (thumbnail_->getTotalLength() > 0.0)
-			repaint();
+		return;
 	}
+
+	const int columns_to_render = static_cast<int>(jmin<int64>(number_of_new_columns, width));
+
+	if (columns_to_render < width)
+	{
+		image_.moveImageSection(0, 0, columns_to_render, 0, width - columns_to_render, image_.getHeight());
+	}
+
+	render_columns(width - columns_to_render, column_index - columns_to_render, columns_to_render);
+	last_column_index_ = column_index;
+
+	repaint();
 }
 
-void WaveFormDisplay::timerCallback()
+void WaveFormDisplay::render_columns(const int first_image_column, const int64 first_column_index,
+                                     const int number_of_columns)
 {
-	// double currentTime = transportSource.getCurrentPosition();
-	// transportPosition.setStart(currentTime);
-	// transportPosition.setEnd(currentTime + 8.0);
-	// repaint();
+	Graphics g(image_);
+
+	g.setColour(background_colour_);
+	g.fillRect(first_image_column, 0, number_of_columns, image_.getHeight());
+
+	const int number_of_channels = recording_buffer_.get_number_of_channels();
+	const float lane_height = static_cast<float>(image_.getHeight()) / jmax(1, number_of_channels);
+
+	const int64 start_position = first_column_index * samples_per_column_;
+	const int64 end_position = start_position + number_of_columns * samples_per_column_;
+
+	for (int channel = 0; channel < number_of_channels; ++channel)
+	{
+		recording_buffer_.read_waveform_columns(channel, start_position, end_position, columns_.data(),
+		                                        number_of_columns);
+
+		const float centre = lane_height * (channel + 0.5f);
+		const float half_height = lane_height * 0.5f;
+
+		for (int column = 0; column < number_of_columns; ++column)
+		{
+			const auto& values = columns_[static_cast<size_t>(column)];
+			const int x = first_image_column + column;
+
+			g.setColour(peak_colour_);
+			g.drawVerticalLine(x, centre - jlimit(-1.f, 1.f, values.max) * half_height,
+			                   centre - jlimit(-1.f, 1.f, values.min) * half_height + 1.f);
+
+			g.setColour(rms_colour_);
+			const float rms = jmin(1.f, values.rms) * half_height;
+			g.drawVerticalLine(x, centre - rms, centre + rms + 1.f);
+		}
+	}
 }
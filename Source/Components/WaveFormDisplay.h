@@ -12,34 +12,47 @@
 
 #include <JuceHeader.h>
 
+#include "RecordingBuffer.h"
+#include "RefreshScheduler.h"
+
 using namespace juce;
 
+//==============================================================================
+/*
+	Live view of the recorded sidechain. Columns are aligned on absolute sample
+	positions, so each frame only the columns that completed since the last one are
+	read from the RecordingBuffer's peak pyramid and drawn into a cached image; the
+	rest of the image is scrolled left by a blit. Driven by the editor's RefreshScheduler.
+*/
 class WaveFormDisplay : public Component,
-                        public ChangeListener,
-                        public Timer
+                        public RefreshScheduler::Client
 
 {
 public:
-	WaveFormDisplay();
+	explicit WaveFormDisplay(const RecordingBuffer& recording_buffer, double visible_length_in_seconds = 3.);
 	~WaveFormDisplay() override;
 
 	void paint(juce::Graphics&) override;
 	void resized() override;
+	void refresh() override;
 
 private:
-	void changeListenerCallback(ChangeBroadcaster* source) override;
-	void timerCallback() override;
+	void render_columns(int first_image_column, int64 first_column_index, int number_of_columns);
 	//==============================================================================
-	AudioFormatManager formatManager;
-	// AudioTransportSource& transportSource;
-	AudioThumbnailCache thumbnailCache;
-	std::unique_ptr<AudioThumbnail> thumbnail_;
-	int source_samples_per_thumbnail_sample_ {512};
-	bool enable_transport_follow_ = false;
+	const RecordingBuffer& recording_buffer_;
+	const double visible_length_in_seconds_;
 
-	//==============================================================================
-	Rectangle<int> bottomThumbArea;
-	Rectangle<int> topThumbArea;
+	Image image_;
+	std::vector<PeakPyramid::Column> columns_;
+
+	double sample_rate_ = 0.;
+	int64 samples_per_column_ = 0;
+	int64 last_column_index_ = 0;
+	bool needs_full_redraw_ = true;
+
+	Colour background_colour_ = Colour(37, 37, 37);
+	Colour peak_colour_ = Colour::fromRGBA(255, 255, 255, 101);
+	Colour rms_colour_ = Colours::white;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveFormDisplay)
 };
@@ -0,0 +1,356 @@
+/*
+  ==============================================================================
+
+    Headless render of WhooshGeneratorAudioProcessor. Streams a sidechain file,
+    and optionally a main input file, through processBlock at the requested block
+    sizes and writes, for each of them, the rendered audio and a CSV with the
+    analyzer envelopes and the time every block took. With --reference, the
+    envelopes are compared against a previous render and the exit code reports
+    any difference larger than the tolerance.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../WhooshGenerator/PluginProcessor.h"
+
+using namespace juce;
+
+namespace
+{
+	struct render_settings
+	{
+		File sidechain_file;
+		File main_file;
+		File output_directory;
+		File reference_directory;
+		double sample_rate = 0.;
+		Array<int> block_sizes;
+		float tolerance = 1e-4f;
+	};
+
+	//==============================================================================
+	// A file read at the render sample rate, mapped onto however many channels its bus has.
+	class InputFile
+	{
+	public:
+		InputFile(AudioFormatReader* reader, const double sample_rate, const int block_size):
+			number_of_channels_(static_cast<int>(reader->numChannels)),
+			length_in_samples_(static_cast<int64>(reader->lengthInSamples * sample_rate / reader->sampleRate)),
+			reader_source_(reader, true),
+			resampling_source_(&reader_source_, false, number_of_channels_),
+			file_buffer_(number_of_channels_, block_size)
+		{
+			resampling_source_.setResamplingRatio(reader->sampleRate / sample_rate);
+			resampling_source_.prepareToPlay(block_size, sample_rate);
+		}
+
+		void read(AudioBuffer<float>& destination)
+		{
+			const int number_of_samples = destination.getNumSamples();
+			resampling_source_.getNextAudioBlock(AudioSourceChannelInfo(&file_buffer_, 0, number_of_samples));
+
+			for (int channel = 0; channel < destination.getNumChannels(); ++channel)
+			{
+				destination.copyFrom(channel, 0, file_buffer_, jmin(channel, number_of_channels_ - 1), 0,
+				                     number_of_samples);
+			}
+		}
+
+		int64 get_length_in_samples() const noexcept
+		{
+			return length_in_samples_;
+		}
+
+	private:
+		const int number_of_channels_;
+		const int64 length_in_samples_;
+		AudioFormatReaderSource reader_source_;
+		ResamplingAudioSource resampling_source_;
+		AudioBuffer<float> file_buffer_;
+	};
+
+	// WAV files, the plugin's captures included, are mapped whole: an hour-long take costs address space,
+	// not reads or RAM. Other formats are streamed.
+	AudioFormatReader* create_reader(AudioFormatManager& format_manager, const File& file)
+	{
+		if (auto reader = SidechainCapture::create_memory_mapped_reader(file))
+		{
+			return reader.release();
+		}
+		return format_manager.createReaderFor(file);
+	}
+
+	//==============================================================================
+	double get_percentile(std::vector<double> values, const double proportion)
+	{
+		if (values.empty())
+		{
+			return 0.;
+		}
+		const auto index = jmin(values.size() - 1, static_cast<size_t>(proportion * values.size()));
+		std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+		return values[index];
+	}
+
+	String get_column_name(const Analyzer& analyzer)
+	{
+		return analyzer.get_osc_address().trimCharactersAtStart("/").replaceCharacter('/', '_');
+	}
+
+	// Largest difference per envelope column; the first two columns are the block index and its timing.
+	bool compare_envelopes(const File& rendered_file, const File& reference_file, const float tolerance)
+	{
+		StringArray rendered_lines, reference_lines;
+		rendered_file.readLines(rendered_lines);
+		reference_file.readLines(reference_lines);
+		rendered_lines.removeEmptyStrings();
+		reference_lines.removeEmptyStrings();
+
+		if (rendered_lines.isEmpty() || rendered_lines[0] != reference_lines[0]
+			|| rendered_lines.size() != reference_lines.size())
+		{
+			std::cout << "  reference " << reference_file.getFullPathName() << " has another layout or length"
+				<< std::endl;
+			return false;
+		}
+
+		const auto column_names = StringArray::fromTokens(rendered_lines[0], ",", {});
+		std::vector<float> max_differences(static_cast<size_t>(column_names.size()), 0.f);
+
+		for (int line = 1; line < rendered_lines.size(); ++line)
+		{
+			const auto rendered = StringArray::fromTokens(rendered_lines[line], ",", {});
+			const auto reference = StringArray::fromTokens(reference_lines[line], ",", {});
+
+			for (int column = 2; column < column_names.size(); ++column)
+			{
+				const float difference = std::abs(rendered[column].getFloatValue() - reference[column].getFloatValue());
+				max_differences[column] = jmax(max_differences[column], difference);
+			}
+		}
+
+		bool is_matching = true;
+		for (int column = 2; column < column_names.size(); ++column)
+		{
+			const bool is_column_matching = max_differences[column] <= tolerance;
+			is_matching = is_matching && is_column_matching;
+
+			std::cout << "  " << column_names[column] << ": max difference " << max_differences[column]
+				<< (is_column_matching ? "" : "  <-- above tolerance") << std::endl;
+		}
+		return is_matching;
+	}
+
+	//==============================================================================
+	bool render(const render_settings& settings, AudioFormatManager& format_manager, const int block_size)
+	{
+		const double sample_rate = settings.sample_rate;
+
+		auto processor = std::make_unique<WhooshGeneratorAudioProcessor>();
+		processor->enableAllBuses();
+		processor->set_parameters_default_value();
+		processor->setRateAndBufferSizeDetails(sample_rate, block_size);
+		processor->prepareToPlay(sample_rate, block_size);
+
+		InputFile sidechain(create_reader(format_manager, settings.sidechain_file), sample_rate, block_size);
+		std::unique_ptr<InputFile> main_input;
+		if (settings.main_file != File())
+		{
+			main_input = std::make_unique<InputFile>(create_reader(format_manager, settings.main_file), sample_rate,
+			                                         block_size);
+		}
+
+		const int number_of_output_channels = processor->getTotalNumOutputChannels();
+		AudioBuffer<float> buffer(jmax(processor->getTotalNumInputChannels(), number_of_output_channels), block_size);
+		MidiBuffer midi_messages;
+
+		const String suffix = "_" + String(block_size);
+		const auto audio_file = settings.output_directory.getChildFile("render" + suffix + ".wav");
+		const auto envelopes_file = settings.output_directory.getChildFile("envelopes" + suffix + ".csv");
+		audio_file.deleteFile();
+		envelopes_file.deleteFile();
+
+		WavAudioFormat wav_format;
+		std::unique_ptr<AudioFormatWriter> writer(
+			wav_format.createWriterFor(audio_file.createOutputStream().release(), sample_rate,
+			                           static_cast<unsigned int>(number_of_output_channels), 24, {}, 0));
+		FileOutputStream envelopes(envelopes_file);
+
+		if (writer == nullptr || envelopes.failedToOpen())
+		{
+			std::cout << "Cannot write to " << settings.output_directory.getFullPathName() << std::endl;
+			return false;
+		}
+
+		const auto& analyzers = processor->get_analyzers();
+		envelopes << "block,block_time_in_us";
+		for (const auto* analyzer : analyzers)
+		{
+			envelopes << "," << get_column_name(*analyzer);
+		}
+		envelopes << "\n";
+
+		const int64 length_in_samples = sidechain.get_length_in_samples();
+		std::vector<double> block_times;
+		block_times.reserve(static_cast<size_t>(length_in_samples / block_size + 1));
+
+		for (int64 position = 0; position < length_in_samples; position += block_size)
+		{
+			buffer.clear();
+
+			auto sidechain_buffer = processor->getBusBuffer(buffer, true, 1);
+			sidechain.read(sidechain_buffer);
+
+			if (main_input != nullptr)
+			{
+				auto main_buffer = processor->getBusBuffer(buffer, true, 0);
+				main_input->read(main_buffer);
+			}
+
+			const auto start_ticks = Time::getHighResolutionTicks();
+			processor->processBlock(buffer, midi_messages);
+			const double block_time = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start_ticks);
+			block_times.push_back(block_time);
+
+			const int number_of_samples = static_cast<int>(jmin<int64>(block_size, length_in_samples - position));
+			writer->writeFromAudioSampleBuffer(buffer, 0, number_of_samples);
+
+			envelopes << String(position / block_size) << "," << String(block_time * 1e6, 2);
+			for (const auto* analyzer : analyzers)
+			{
+				envelopes << "," << String(analyzer->get_last_value(), 6);
+			}
+			envelopes << "\n";
+		}
+
+		processor->releaseResources();
+		writer.reset();
+		envelopes.flush();
+
+		//==============================================================================
+		const double block_duration = block_size / sample_rate;
+		const double audio_duration = length_in_samples / sample_rate;
+		const double processing_duration = std::accumulate(block_times.begin(), block_times.end(), 0.);
+		const double p50 = get_percentile(block_times, 0.5);
+		const double p99 = get_percentile(block_times, 0.99);
+		const double max = block_times.empty() ? 0. : *std::max_element(block_times.begin(), block_times.end());
+
+		std::cout << "Block size " << block_size << " at " << sample_rate << " Hz: "
+			<< String(audio_duration, 2) << " s of audio in " << String(processing_duration, 3) << " s, "
+			<< "realtime factor " << String(audio_duration / jmax(processing_duration, 1e-9), 1) << "x" << std::endl;
+		std::cout << "  block p50 " << String(p50 * 1e3, 3) << " ms, p99 " << String(p99 * 1e3, 3) << " ms, max "
+			<< String(max * 1e3, 3) << " ms (p99 is " << String(100. * p99 / block_duration, 2)
+			<< " % of the block)" << std::endl;
+
+		for (const auto& statistics : processor->get_process_load_monitor().get_element_statistics())
+		{
+			std::cout << "  " << statistics.name << ": p50 " << String(statistics.p50 * 100.f, 3) << " %, p99 "
+				<< String(statistics.p99 * 100.f, 3) << " %, max " << String(statistics.max * 100.f, 3) << " %"
+				<< std::endl;
+		}
+
+		if (settings.reference_directory != File())
+		{
+			return compare_envelopes(envelopes_file, settings.reference_directory.getChildFile(envelopes_file.getFileName()),
+			                         settings.tolerance);
+		}
+		return true;
+	}
+
+	void print_usage()
+	{
+		std::cout << "Usage: WhooshGeneratorOfflineRender --sidechain=<file> [options]\n"
+			"  --main=<file>            main input, silence when omitted\n"
+			"  --output=<directory>     where render_<block>.wav and envelopes_<block>.csv go (current directory)\n"
+			"  --sample-rate=<hz>       render sample rate, inputs are resampled (sidechain file rate)\n"
+			"  --block-sizes=<a,b,...>  block sizes to render with (512)\n"
+			"  --reference=<directory>  compare envelopes with a previous render, non-zero exit on mismatch\n"
+			"  --tolerance=<value>      largest accepted envelope difference (0.0001)" << std::endl;
+	}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+	// The processor owns a Timer and parameters, which both expect a message manager.
+	const ScopedJuceInitialiser_GUI juce_initialiser;
+
+	const ArgumentList arguments(argc, argv);
+
+	if (arguments.containsOption("--help|-h") || ! arguments.containsOption("--sidechain"))
+	{
+		print_usage();
+		return arguments.containsOption("--help|-h") ? 0 : 1;
+	}
+
+	AudioFormatManager format_manager;
+	format_manager.registerBasicFormats();
+
+	render_settings settings;
+	settings.sidechain_file = File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--sidechain"));
+
+	if (arguments.containsOption("--main"))
+	{
+		settings.main_file = File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--main"));
+	}
+	if (arguments.containsOption("--reference"))
+	{
+		settings.reference_directory = File::getCurrentWorkingDirectory().getChildFile(
+			arguments.getValueForOption("--reference"));
+	}
+
+	settings.output_directory = arguments.containsOption("--output")
+		                            ? File::getCurrentWorkingDirectory().getChildFile(
+			                            arguments.getValueForOption("--output"))
+		                            : File::getCurrentWorkingDirectory();
+	settings.output_directory.createDirectory();
+
+	for (const auto& file : {settings.sidechain_file, settings.main_file})
+	{
+		if (file == File())
+		{
+			continue;
+		}
+
+		const std::unique_ptr<AudioFormatReader> reader(format_manager.createReaderFor(file));
+		if (reader == nullptr)
+		{
+			std::cout << "Missing or unsupported audio file: " << file.getFullPathName() << std::endl;
+			return 1;
+		}
+		if (file == settings.sidechain_file)
+		{
+			settings.sample_rate = reader->sampleRate;
+		}
+	}
+
+	if (arguments.containsOption("--sample-rate"))
+	{
+		settings.sample_rate = arguments.getValueForOption("--sample-rate").getDoubleValue();
+	}
+
+	for (const auto& block_size : StringArray::fromTokens(arguments.getValueForOption("--block-sizes"), ",", {}))
+	{
+		if (block_size.getIntValue() > 0)
+		{
+			settings.block_sizes.add(block_size.getIntValue());
+		}
+	}
+	if (settings.block_sizes.isEmpty())
+	{
+		settings.block_sizes.add(512);
+	}
+	if (arguments.containsOption("--tolerance"))
+	{
+		settings.tolerance = arguments.getValueForOption("--tolerance").getFloatValue();
+	}
+
+	bool is_successful = true;
+	for (const int block_size : settings.block_sizes)
+	{
+		is_successful = render(settings, format_manager, block_size) && is_successful;
+	}
+	return is_successful ? 0 : 1;
+}
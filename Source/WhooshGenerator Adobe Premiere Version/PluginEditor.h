@@ -9,13 +9,14 @@
 #include "../Components/VolumeAnalyzer.h"
 #include "../Components/SpectrumComponent.h"
 #include "../Components/SampleManager.h"
+#include "../Components/RefreshScheduler.h"
 
 using namespace juce;
 
 //==============================================================================
 /**
 */
-class WhooshGeneratorAudioProcessorEditor : public juce::AudioProcessorEditor, private Timer
+class WhooshGeneratorAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
 	WhooshGeneratorAudioProcessorEditor(WhooshGeneratorAudioProcessor&);
@@ -28,8 +29,6 @@ public:
 	static int get_number_of_blocks_from_milliseconds(double sample_rate, float length_in_milliseconds,
 	                                                  int samples_per_block);
 
-	int number_of_samples_to_display = 0;
-
 private:
 	// This reference is provided as a quick way for your editor to
 	// access the processor object that created it.
@@ -37,12 +36,6 @@ private:
 
 	ParametersBox in_parameters_box_;
 
-	void enableRecording();
-
-	void timerCallback() override;
-
-	AudioSampleBuffer* audioBuffer;
-
 	//==================================================
 	WaveFormDisplay waveform_;
 //	OutParametersBox out_parameters_box_;
@@ -50,12 +43,13 @@ private:
 
 	//==================================================
 
-	RecordingBuffer* audio_source;
 	MyLookAndFeel my_look_and_feel_;
 
 	//==================================================
 	std::vector<Component*> components;
 
+	// Declared last so it stops ticking before any of its clients is destroyed.
+	RefreshScheduler refresh_scheduler_;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WhooshGeneratorAudioProcessorEditor)
 };
@@ -16,6 +16,9 @@ WhooshGeneratorAudioProcessor::WhooshGeneratorAudioProcessor() : out_parameters_
 	                                                                 this, SpectrumAnalyzer::fft_size)),
                                                                  intern_parameters_(
 	                                                                 std::make_unique<InternParametersState>(this)),
+                                                                 in_parameters_smoother_(
+	                                                                 std::make_unique<ParametersSmoother>(
+		                                                                 in_parameters_->get_state())),
                                                                  internal_foley_input_(
 	                                                                 std::make_unique<FoleyInput>()),
                                                                  volume_analyzer_(
@@ -24,7 +27,8 @@ WhooshGeneratorAudioProcessor::WhooshGeneratorAudioProcessor() : out_parameters_
 			                                                                 out_parameters_->
 			                                                                 get_state()->getParameter(
 				                                                                 parameters::volume_out.id)),
-		                                                                 in_parameters_->get_state())),
+		                                                                 in_parameters_->get_state(),
+		                                                                 in_parameters_smoother_.get())),
                                                                  gain_processor_(
 	                                                                 std::make_unique<GainProcess>(
 		                                                                 out_parameters_->get_state()->getParameter(
@@ -66,6 +70,9 @@ WhooshGeneratorAudioProcessor::WhooshGeneratorAudioProcessor() : out_parameters_
 
 	analyzers_ = {volume_analyzer_.get()};
 
+	// No spectrum analysis in this version: grains keep their centre pitch, and layers routed to
+	// band energy or frequency play unmodulated.
+	internal_foley_input_->set_modulation_analyzer(FoleyInput::VOLUME, volume_analyzer_.get());
 }
 
 WhooshGeneratorAudioProcessor::~WhooshGeneratorAudioProcessor()
@@ -133,10 +140,20 @@ void WhooshGeneratorAudioProcessor::changeProgramName(int index, const juce::Str
 //==============================================================================
 void WhooshGeneratorAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	audioSource.prepareToPlay(samplesPerBlock, sampleRate);
+	audioSource.prepare(getChannelCountOfBus(true, 0), samplesPerBlock, sampleRate);
+	in_parameters_smoother_->prepareToPlay(sampleRate, samplesPerBlock);
+	process_load_monitor_.prepare(sampleRate);
+	internal_foley_input_->prepareToPlay(sampleRate, samplesPerBlock);
+	process_load_monitor_.add_element(internal_foley_input_.get());
+	foley_buffer_.setSize(jmax(1, getTotalNumOutputChannels()), jmax(1, samplesPerBlock));
 	for (std::list<AudioChainElement*>::value_type element : sidechain_input_processing_chain_)
 	{
 		element->prepareToPlay(sampleRate, samplesPerBlock);
+		process_load_monitor_.add_element(element);
+	}
+	for (std::list<AudioChainElement*>::value_type element : input_processing_chain_)
+	{
+		process_load_monitor_.add_element(element);
 	}
 }
 
@@ -176,6 +193,7 @@ bool WhooshGeneratorAudioProcessor::isBusesLayoutSupported(const BusesLayout& la
 void WhooshGeneratorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
 	ScopedNoDenormals noDenormals;
+	const ProcessLoadMonitor::ScopedBlock scoped_block(process_load_monitor_, buffer.getNumSamples());
 
 	const int total_num_input_channels = getTotalNumInputChannels();
 	const int total_num_output_channels = getTotalNumOutputChannels();
@@ -186,36 +204,53 @@ void WhooshGeneratorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffe
 	{
 		buffer.clear(channel, 0, buffer.getNumSamples());
 	}
+	in_parameters_smoother_->advance(buffer.getNumSamples());
+
 	AudioPlayHead* playHead = getPlayHead();
 	AudioPlayHead::CurrentPositionInfo positionInfo{};
 
 	const int input_buses_count = getBusCount(true);
 
-	AudioBuffer<float> foley_input = AudioBuffer<float>(getTotalNumOutputChannels(), getBlockSize());
 	AudioBuffer<float> side_chain_input = getBusBuffer(buffer, true, 0);
 
-	internal_foley_input_->getNextAudioBlock(foley_input);
-
 	for (std::list<AudioChainElement>::value_type* element : sidechain_input_processing_chain_)
 	{
-		element->getNextAudioBlock(side_chain_input);
+		process_load_monitor_.process(element, side_chain_input);
 	}
 
-	for (std::list<AudioChainElement>::value_type* element : input_processing_chain_)
+	audioSource.getNextAudioBlock(AudioSourceChannelInfo(side_chain_input));
+
+	if (foley_buffer_.getNumSamples() == 0)
 	{
-		element->getNextAudioBlock(foley_input);
+		// Not prepared yet.
+		buffer.clear();
+		return;
 	}
 
-
-	for (int channel = 0; channel < 2; ++channel)
+	// After the analysis, so the granular mode follows this block's volume. Blocks longer
+	// than the prepared size are rendered in several parts rather than allocating.
+	const int number_of_channels = jmin(buffer.getNumChannels(), foley_buffer_.getNumChannels());
+	for (int start_sample = 0; start_sample < buffer.getNumSamples();)
 	{
-		auto* buffer_to_fill = buffer.getWritePointer(channel);
-		auto* buffer_with_noise = foley_input.getWritePointer(channel);
+		const int length = jmin(buffer.getNumSamples() - start_sample, foley_buffer_.getNumSamples());
+		AudioBuffer<float> foley_input(foley_buffer_.getArrayOfWritePointers(), foley_buffer_.getNumChannels(), length);
+
+		process_load_monitor_.process(internal_foley_input_.get(), foley_input);
 
-		for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+		for (std::list<AudioChainElement>::value_type* element : input_processing_chain_)
 		{
-			buffer_to_fill[sample] = buffer_with_noise[sample];
+			process_load_monitor_.process(element, foley_input);
 		}
+
+		for (int channel = 0; channel < number_of_channels; ++channel)
+		{
+			buffer.copyFrom(channel, start_sample, foley_input, channel, 0, length);
+		}
+		start_sample += length;
+	}
+	for (int channel = number_of_channels; channel < buffer.getNumChannels(); ++channel)
+	{
+		buffer.clear(channel, 0, buffer.getNumSamples());
 	}
 }
 
@@ -229,6 +264,7 @@ void WhooshGeneratorAudioProcessor::add_element_to_fx_chain(AudioChainElement* e
 {
 	sidechain_input_processing_chain_.push_back(element);
 	element->prepareToPlay(getSampleRate(), getBlockSize());
+	process_load_monitor_.add_element(element);
 }
 
 void WhooshGeneratorAudioProcessor::remove_element_to_fx_chain(AudioChainElement* element)
@@ -281,6 +317,11 @@ FoleyInput* WhooshGeneratorAudioProcessor::get_internal_foley_input() const
 	return internal_foley_input_.get();
 }
 
+const ProcessLoadMonitor& WhooshGeneratorAudioProcessor::get_process_load_monitor() const
+{
+	return process_load_monitor_;
+}
+
 
 //==============================================================================
 // This creates new instances of the plugin..
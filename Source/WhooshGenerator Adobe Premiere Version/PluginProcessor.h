@@ -20,7 +20,9 @@
 #include "../Components/OutputTimer.h"
 #include "../Components/GainProcess.h"
 #include "../Components/InternParametersState.h"
+#include "../Components/ParametersSmoother.h"
 #include "../Components/FoleyInput.h"
+#include "../Components/ProcessLoadMonitor.h"
 
 
 using namespace juce;
@@ -83,11 +85,13 @@ public:
 	[[nodiscard]] ParametersState* get_intern_parameters() const;
 	[[nodiscard]] ParametersState* get_out_parameters() const;
 	[[nodiscard]] FoleyInput* get_internal_foley_input() const;
+	[[nodiscard]] const ProcessLoadMonitor& get_process_load_monitor() const;
 
 private:
 	std::unique_ptr<OutParametersState> out_parameters_;
 	std::unique_ptr<InParametersState> in_parameters_;
 	std::unique_ptr<InternParametersState> intern_parameters_;
+	std::unique_ptr<ParametersSmoother> in_parameters_smoother_;
 
 private:
 	//==============================================================================
@@ -98,10 +102,14 @@ private:
 	std::unique_ptr<GainProcess> gain_processor_;
 
 	std::unique_ptr<FoleyInput> internal_foley_input_;
+	// Sized in prepareToPlay, so rendering the foley input never allocates.
+	AudioBuffer<float> foley_buffer_;
 	//==============================================================================
 	std::list<AudioChainElement*> sidechain_input_processing_chain_;
 	std::list<AudioChainElement*> input_processing_chain_;
 
+	ProcessLoadMonitor process_load_monitor_;
+
 	std::vector<Analyzer*> analyzers_;
 
 	//==============================================================================
@@ -5,26 +5,29 @@
 WhooshGeneratorAudioProcessorEditor::WhooshGeneratorAudioProcessorEditor(WhooshGeneratorAudioProcessor& p)
 	: AudioProcessorEditor(&p), audioProcessor(p),
 	  in_parameters_box_(&p, p.get_in_parameters()->get_state(), SpectrumAnalyzer::fft_size),
-	  out_parameters_box_(p.get_out_parameters()->get_state(), p.get_intern_parameters()->get_state()),
-	  fft_visualizer_(p.get_spectrum_analyzer())
+	  waveform_(p.getAudioSource()),
+	  out_parameters_box_(p.get_out_parameters()->get_state(), p.get_intern_parameters()->get_state(),
+	                      p.get_process_load_monitor()),
+	  fft_visualizer_(p.get_spectrum_analyzer()),
+	  spectrogram_(p.get_spectrum_analyzer()),
+	  refresh_scheduler_(*this)
 {
 	setLookAndFeel(&my_look_and_feel_);
 
-	const double time_to_display_in_seconds = 3.;
-
-	number_of_samples_to_display = time_to_display_in_seconds * p.getSampleRate();
-
-	audio_source = &audioProcessor.getAudioSource();
-
-	std::vector<Component*> components = {&in_parameters_box_, &out_parameters_box_, &fft_visualizer_};
+	std::vector<Component*> components = {&in_parameters_box_, &waveform_, &out_parameters_box_, &fft_visualizer_, &spectrogram_};
 
 	for (std::vector<Component*>::value_type component : components)
 	{
 		addAndMakeVisible(component);
 	}
 
-	enableRecording();
+	setup_analysis_bus_controls();
+	setup_capture_controls();
 
+	for (RefreshScheduler::Client* client : std::initializer_list<RefreshScheduler::Client*>{&waveform_, &fft_visualizer_, &spectrogram_, &out_parameters_box_.get_load_meter(), this})
+	{
+		refresh_scheduler_.add_client(client);
+	}
 
 	p.set_parameters_default_value();
 
@@ -37,6 +40,130 @@ WhooshGeneratorAudioProcessorEditor::~WhooshGeneratorAudioProcessorEditor()
 	setLookAndFeel(nullptr);
 }
 
+void WhooshGeneratorAudioProcessorEditor::setup_analysis_bus_controls()
+{
+	// Item ids are the roles, shifted by one since 0 means no selection.
+	addAndMakeVisible(analysis_bus_role_);
+	analysis_bus_role_.addItem("Local analysis", AnalysisBus::LOCAL + 1);
+	analysis_bus_role_.addItem("Publish to bus", AnalysisBus::SOURCE + 1);
+	analysis_bus_role_.addItem("Follow bus", AnalysisBus::FOLLOWER + 1);
+	analysis_bus_role_.onChange = [this]()
+	{
+		apply_analysis_bus();
+	};
+
+	addAndMakeVisible(analysis_bus_name_);
+	analysis_bus_name_.setTextToShowWhenEmpty("Bus name", Colours::grey);
+	analysis_bus_name_.setText(audioProcessor.get_analysis_bus_name(), dontSendNotification);
+	analysis_bus_name_.onReturnKey = [this]()
+	{
+		apply_analysis_bus();
+	};
+	analysis_bus_name_.onFocusLost = analysis_bus_name_.onReturnKey;
+
+	display_analysis_bus_role();
+}
+
+void WhooshGeneratorAudioProcessorEditor::apply_analysis_bus()
+{
+	const auto role = static_cast<AnalysisBus::role>(analysis_bus_role_.getSelectedId() - 1);
+	const auto name = analysis_bus_name_.getText().trim();
+
+	if (role != audioProcessor.get_requested_analysis_bus_role() || name != audioProcessor.get_analysis_bus_name())
+	{
+		audioProcessor.set_analysis_bus(role, name);
+	}
+	display_analysis_bus_role();
+}
+
+void WhooshGeneratorAudioProcessorEditor::display_analysis_bus_role()
+{
+	const auto requested_role = audioProcessor.get_requested_analysis_bus_role();
+	const auto role = audioProcessor.get_analysis_bus_role();
+	analysis_bus_role_.setSelectedId(requested_role + 1, dontSendNotification);
+	displayed_analysis_bus_role_ = role;
+
+	String tooltip;
+	if (role == AnalysisBus::LOCAL && requested_role != AnalysisBus::LOCAL)
+	{
+		tooltip = "Analysing locally until a bus name is set";
+	}
+	else if (role != requested_role)
+	{
+		tooltip = "Another instance already publishes this name: following it";
+	}
+	analysis_bus_role_.setTooltip(tooltip);
+}
+
+void WhooshGeneratorAudioProcessorEditor::setup_capture_controls()
+{
+	addAndMakeVisible(capture_button_);
+	capture_button_.onClick = [this]()
+	{
+		toggle_capture();
+	};
+
+	addAndMakeVisible(capture_output_button_);
+	capture_output_button_.setTooltip("Also capture the processed output");
+
+	display_capture_state();
+}
+
+void WhooshGeneratorAudioProcessorEditor::toggle_capture()
+{
+	if (audioProcessor.get_sidechain_capture().is_capturing())
+	{
+		audioProcessor.stop_capture();
+		display_capture_state();
+		return;
+	}
+
+	const auto directory = SidechainCapture::get_default_directory();
+	const bool has_started = audioProcessor.start_capture(directory, capture_output_button_.getToggleState());
+	display_capture_state();
+
+	if (! has_started)
+	{
+		capture_button_.setTooltip("Cannot capture to " + directory.getFullPathName()
+			+ ": the sidechain must be connected and the folder writable");
+	}
+}
+
+void WhooshGeneratorAudioProcessorEditor::display_capture_state()
+{
+	const auto& capture = audioProcessor.get_sidechain_capture();
+	is_capture_displayed_ = capture.is_capturing();
+
+	capture_button_.setButtonText(is_capture_displayed_ ? "Stop capture" : "Capture");
+	capture_output_button_.setEnabled(! is_capture_displayed_);
+
+	const auto file = capture.get_file(SidechainCapture::SIDECHAIN);
+	String tooltip = "Write the sidechain to " + SidechainCapture::get_default_directory().getFullPathName();
+
+	if (file != File())
+	{
+		tooltip = (is_capture_displayed_ ? "Capturing to " : "Last take: ") + file.getFullPathName();
+
+		if (capture.get_number_of_dropped_blocks() > 0)
+		{
+			tooltip << " (" << capture.get_number_of_dropped_blocks() << " blocks dropped)";
+		}
+	}
+	capture_button_.setTooltip(tooltip);
+}
+
+void WhooshGeneratorAudioProcessorEditor::refresh()
+{
+	if (audioProcessor.get_analysis_bus_role() != displayed_analysis_bus_role_)
+	{
+		display_analysis_bus_role();
+	}
+	if (audioProcessor.get_sidechain_capture().is_capturing() != is_capture_displayed_)
+	{
+		display_capture_state();
+	}
+}
+
 //==============================================================================
 void WhooshGeneratorAudioProcessorEditor::paint(juce::Graphics& g)
 {
@@ -57,12 +184,21 @@ void WhooshGeneratorAudioProcessorEditor::resized()
 	in_parameters_box_.setBounds(rectangle.removeFromBottom(row_height * 4));
 
 	auto main_rectangle = rectangle;
-	// waveform.setBounds(
-	// 	main_rectangle.removeFromTop(main_rectangle.getHeight() / 3).reduced(delta)
-	// );
-	fft_visualizer_.setBounds(
+
+	auto analysis_bus_row = main_rectangle.removeFromTop(row_height).reduced(delta, 0);
+	capture_output_button_.setBounds(analysis_bus_row.removeFromRight(100).reduced(delta, 2));
+	capture_button_.setBounds(analysis_bus_row.removeFromRight(100).reduced(delta, 2));
+	analysis_bus_role_.setBounds(analysis_bus_row.removeFromLeft(analysis_bus_row.getWidth() / 2).reduced(delta, 2));
+	analysis_bus_name_.setBounds(analysis_bus_row.reduced(delta, 2));
+
+	waveform_.setBounds(
 		main_rectangle.removeFromTop(main_rectangle.getHeight() / 3).reduced(delta)
 	);
+	auto spectrum_rectangle = main_rectangle.removeFromTop(main_rectangle.getHeight() / 2);
+	fft_visualizer_.setBounds(
+		spectrum_rectangle.removeFromLeft(spectrum_rectangle.getWidth() / 2).reduced(delta)
+	);
+	spectrogram_.setBounds(spectrum_rectangle.reduced(delta));
 
 	out_parameters_box_.setBounds(main_rectangle.removeFromTop(main_rectangle.getHeight()).reduced(delta));
 }
@@ -72,27 +208,3 @@ int WhooshGeneratorAudioProcessorEditor::get_number_of_blocks_from_milliseconds(
 {
 	return (int)(((sample_rate / 1000) * length_in_milliseconds) / samples_per_block);
 }
-
-void WhooshGeneratorAudioProcessorEditor::timerCallback()
-{
-	const int end_sample = audio_source->get_sample_index();
-
-	// waveform.updateVisibleRegion(end_sample, number_of_samples_to_display);
-}
-
-
-void WhooshGeneratorAudioProcessorEditor::enableRecording()
-{
-	// waveform.clearWaveform();
-	//
-	// const std::shared_ptr<AudioSampleBuffer> temp_audio_buffer = audio_source->
-	// 	loadRecordingBuffer(number_of_samples_to_display);
-	// waveform.loadWaveform(
-	// 	temp_audio_buffer.get(), audio_source->getSampleRate(), audio_source->getBufferUpdateLock()
-	// );
-
-
-	// audioBuffer = temp_audio_buffer.get();
-
-	startTimerHz(100);
-}
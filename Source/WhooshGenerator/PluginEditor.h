@@ -7,13 +7,17 @@
 #include "../Components/OutParameterBox.h"
 #include "../Components/VolumeAnalyzer.h"
 #include "../Components/SpectrumComponent.h"
+#include "../Components/WaveFormDisplay.h"
+#include "../Components/SpectrogramComponent.h"
+#include "../Components/RefreshScheduler.h"
 
 using namespace juce;
 
 //==============================================================================
 /**
 */
-class WhooshGeneratorAudioProcessorEditor : public juce::AudioProcessorEditor, private Timer
+class WhooshGeneratorAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                            private RefreshScheduler::Client
 {
 public:
 	WhooshGeneratorAudioProcessorEditor(WhooshGeneratorAudioProcessor&);
@@ -26,30 +30,42 @@ public:
 	static int get_number_of_blocks_from_milliseconds(double sample_rate, float length_in_milliseconds,
 	                                                  int samples_per_block);
 
-	int number_of_samples_to_display = 0;
-
 private:
+	void setup_analysis_bus_controls();
+	void apply_analysis_bus();
+	void display_analysis_bus_role();
+	void setup_capture_controls();
+	void toggle_capture();
+	void display_capture_state();
+	// Follows the role in effect, which the audio thread changes when a demoted source takes the bus back,
+	// and the capture, which a new channel layout ends.
+	void refresh() override;
+
 	// This reference is provided as a quick way for your editor to
 	// access the processor object that created it.
 	WhooshGeneratorAudioProcessor& audioProcessor;
 
 	ParametersBox in_parameters_box_;
 
-	void enableRecording();
-
-	void timerCallback() override;
-
-	AudioSampleBuffer* audioBuffer;
-
 	//==================================================
+	WaveFormDisplay waveform_;
 	OutParametersBox out_parameters_box_;
 	SpectrumComponent fft_visualizer_;
+	SpectrogramComponent spectrogram_;
+	//==================================================
+	ComboBox analysis_bus_role_{"analysis_bus_role"};
+	TextEditor analysis_bus_name_{"analysis_bus_name"};
+	AnalysisBus::role displayed_analysis_bus_role_ = AnalysisBus::LOCAL;
+	TextButton capture_button_{"Capture"};
+	ToggleButton capture_output_button_{"With output"};
+	bool is_capture_displayed_ = false;
 	//==================================================
 
-	RecordingBuffer* audio_source;
 	MyLookAndFeel my_look_and_feel_;
 
 	//==================================================
+	// Declared last so it stops ticking before any of its clients is destroyed.
+	RefreshScheduler refresh_scheduler_;
 
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WhooshGeneratorAudioProcessorEditor)
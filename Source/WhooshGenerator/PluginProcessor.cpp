@@ -16,20 +16,25 @@ WhooshGeneratorAudioProcessor::WhooshGeneratorAudioProcessor() : out_parameters_
 	                                                                 this, SpectrumAnalyzer::fft_size)),
                                                                  intern_parameters_(
 	                                                                 std::make_unique<InternParametersState>(this)),
+                                                                 in_parameters_smoother_(
+	                                                                 std::make_unique<ParametersSmoother>(
+		                                                                 in_parameters_->get_state())),
                                                                  volume_analyzer_(
 	                                                                 std::make_unique<VolumeAnalyzer>(
 		                                                                 static_cast<AudioParameterFloat*>(
 			                                                                 out_parameters_->
 			                                                                 get_state()->getParameter(
 				                                                                 parameters::volume_out.id)),
-		                                                                 in_parameters_->get_state())),
+		                                                                 in_parameters_->get_state(),
+		                                                                 in_parameters_smoother_.get())),
                                                                  spectrum_analyzer_(
 	                                                                 std::make_unique<SpectrumAnalyzer>(
 		                                                                 static_cast<AudioParameterFloat*>(
 			                                                                 out_parameters_->
 			                                                                 get_state()->getParameter(
 				                                                                 parameters::frequency_out.id)),
-		                                                                 in_parameters_->get_state())),
+		                                                                 in_parameters_->get_state(),
+		                                                                 in_parameters_smoother_.get())),
                                                                  gain_processor_(
 	                                                                 std::make_unique<GainProcess>(
 		                                                                 out_parameters_->get_state()->getParameter(
@@ -63,6 +68,31 @@ WhooshGeneratorAudioProcessor::WhooshGeneratorAudioProcessor() : out_parameters_
 
 	analyzers_ = {volume_analyzer_.get(), spectrum_analyzer_.get()};
 
+	static_assert(parameters::partials.size() == PartialTracker::number_of_outputs,
+		"every tracked partial needs a frequency and an amplitude out parameter");
+
+	for (int rank = 0; rank < PartialTracker::number_of_outputs; ++rank)
+	{
+		const auto& partial = parameters::partials[rank];
+
+		partial_outputs_.emplace_back(std::make_unique<PartialOutput>(
+			static_cast<AudioParameterFloat*>(out_parameters_->get_state()->getParameter(partial.first.id)),
+			in_parameters_->get_state(), in_parameters_smoother_.get(), spectrum_analyzer_->get_partial_tracker(), rank,
+			util::PARTIAL_FREQUENCY));
+		partial_outputs_.emplace_back(std::make_unique<PartialOutput>(
+			static_cast<AudioParameterFloat*>(out_parameters_->get_state()->getParameter(partial.second.id)),
+			in_parameters_->get_state(), in_parameters_smoother_.get(), spectrum_analyzer_->get_partial_tracker(), rank,
+			util::PARTIAL_AMPLITUDE));
+	}
+	for (const auto& partial_output : partial_outputs_)
+	{
+		analyzers_.push_back(partial_output.get());
+	}
+
+	// Every output travels on the bus, so a follower needs neither the FFT nor the partial tracker.
+	bus_analyzers_ = analyzers_;
+	jassert(bus_analyzers_.size() <= AnalysisBus::max_values);
+
 	OutputTimer::set_intern_parameters(intern_parameters_.get());
 
 
@@ -81,6 +111,7 @@ WhooshGeneratorAudioProcessor::WhooshGeneratorAudioProcessor() : out_parameters_
 
 WhooshGeneratorAudioProcessor::~WhooshGeneratorAudioProcessor()
 {
+	set_analysis_bus(AnalysisBus::LOCAL, {});
 }
 
 //==============================================================================
@@ -144,10 +175,18 @@ void WhooshGeneratorAudioProcessor::changeProgramName(int index, const juce::Str
 //==============================================================================
 void WhooshGeneratorAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	audioSource.prepareToPlay(samplesPerBlock, sampleRate);
+	audioSource.prepare(getChannelCountOfBus(true, 1), samplesPerBlock, sampleRate);
+	sidechain_capture_.prepare(sampleRate, getChannelCountOfBus(true, 1), getTotalNumOutputChannels());
+	in_parameters_smoother_->prepareToPlay(sampleRate, samplesPerBlock);
+	process_load_monitor_.prepare(sampleRate);
 	for (std::list<AudioChainElement*>::value_type element : sidechain_input_processing_chain_)
 	{
 		element->prepareToPlay(sampleRate, samplesPerBlock);
+		process_load_monitor_.add_element(element);
+	}
+	for (std::list<AudioChainElement*>::value_type element : input_processing_chain_)
+	{
+		process_load_monitor_.add_element(element);
 	}
 }
 
@@ -187,6 +226,7 @@ bool WhooshGeneratorAudioProcessor::isBusesLayoutSupported(const BusesLayout& la
 void WhooshGeneratorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
 	ScopedNoDenormals noDenormals;
+	const ProcessLoadMonitor::ScopedBlock scoped_block(process_load_monitor_, buffer.getNumSamples());
 
 	const int total_num_input_channels = getTotalNumInputChannels();
 	const int total_num_output_channels = getTotalNumOutputChannels();
@@ -197,6 +237,8 @@ void WhooshGeneratorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffe
 	{
 		buffer.clear(channel, 0, buffer.getNumSamples());
 	}
+	in_parameters_smoother_->advance(buffer.getNumSamples());
+
 	AudioPlayHead* playHead = getPlayHead();
 	AudioPlayHead::CurrentPositionInfo positionInfo{};
 	is_playing_ = false;
@@ -214,17 +256,29 @@ void WhooshGeneratorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffe
 
 	auto selectedBuffer = sideChainInput;
 
+	sidechain_capture_.write(SidechainCapture::SIDECHAIN, sideChainInput);
+
+	// Followers still run the chain: only the analyzers given a bus value skip computing it.
+	const bool is_following = follow_analysis_bus();
+
 	for (std::list<AudioChainElement>::value_type* element : sidechain_input_processing_chain_)
 	{
-		element->getNextAudioBlock(sideChainInput);
+		process_load_monitor_.process(element, sideChainInput);
+	}
+
+	if (! is_following)
+	{
+		publish_to_analysis_bus();
 	}
 
 	for (std::list<AudioChainElement>::value_type* element : input_processing_chain_)
 	{
-		element->getNextAudioBlock(mainInput);
+		process_load_monitor_.process(element, mainInput);
 	}
 
-	audioSource.getNextAudioBlock(AudioSourceChannelInfo(mainInput));
+	audioSource.getNextAudioBlock(AudioSourceChannelInfo(sideChainInput));
+
+	sidechain_capture_.write(SidechainCapture::OUTPUT, buffer);
 }
 
 //==============================================================================
@@ -237,6 +291,7 @@ void WhooshGeneratorAudioProcessor::add_element_to_fx_chain(AudioChainElement* e
 {
 	sidechain_input_processing_chain_.push_back(element);
 	element->prepareToPlay(getSampleRate(), getBlockSize());
+	process_load_monitor_.add_element(element);
 }
 
 void WhooshGeneratorAudioProcessor::remove_element_to_fx_chain(AudioChainElement* element)
@@ -268,7 +323,9 @@ RecordingBuffer& WhooshGeneratorAudioProcessor::getAudioSource()
 
 void WhooshGeneratorAudioProcessor::getCurrentProgramStateInformation(juce::MemoryBlock& destData)
 {
-	const auto in_state = in_parameters_->get_state()->copyState();
+	auto in_state = in_parameters_->get_state()->copyState();
+	in_state.setProperty(AnalysisBus::role_property, get_requested_analysis_bus_role(), nullptr);
+	in_state.setProperty(AnalysisBus::name_property, get_analysis_bus_name(), nullptr);
 
 	std::unique_ptr<juce::XmlElement> xml(in_state.createXml());
 
@@ -280,8 +337,17 @@ void WhooshGeneratorAudioProcessor::setCurrentProgramStateInformation(const void
 	const std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
 	if (xmlState != nullptr)
+	{
 		if (xmlState->hasTagName(in_parameters_->get_state()->state.getType()))
-			in_parameters_->get_state()->replaceState(juce::ValueTree::fromXml(*xmlState));
+		{
+			const auto in_state = juce::ValueTree::fromXml(*xmlState);
+			in_parameters_->get_state()->replaceState(in_state);
+
+			set_analysis_bus(static_cast<AnalysisBus::role>(static_cast<int>(
+				                 in_state.getProperty(AnalysisBus::role_property, AnalysisBus::LOCAL))),
+			                 in_state.getProperty(AnalysisBus::name_property).toString());
+		}
+	}
 }
 
 SpectrumAnalyzer* WhooshGeneratorAudioProcessor::get_spectrum_analyzer()
@@ -289,6 +355,11 @@ SpectrumAnalyzer* WhooshGeneratorAudioProcessor::get_spectrum_analyzer()
 	return spectrum_analyzer_.get();
 }
 
+const std::vector<Analyzer*>& WhooshGeneratorAudioProcessor::get_analyzers() const
+{
+	return analyzers_;
+}
+
 ParametersState* WhooshGeneratorAudioProcessor::get_in_parameters() const
 {
 	return in_parameters_.get();
@@ -312,6 +383,143 @@ void WhooshGeneratorAudioProcessor::set_parameters_default_value() const
 	}
 }
 
+//==============================================================================
+void WhooshGeneratorAudioProcessor::set_analysis_bus(const AnalysisBus::role role, const String& name)
+{
+	// Slots are never deleted, so their name is read through the pointer from any thread; a local
+	// instance keeps its slot too, only to remember the name.
+	auto* slot = name.isNotEmpty() ? analysis_bus_->get_slot(name) : nullptr;
+
+	const SpinLock::ScopedLockType lock(analysis_bus_lock_);
+	analysis_bus_role_.store(AnalysisBus::LOCAL);
+	analysis_bus_requested_role_.store(role);
+
+	if (auto* previous_slot = analysis_bus_slot_.exchange(slot))
+	{
+		previous_slot->release(this);
+	}
+
+	if (role == AnalysisBus::LOCAL || slot == nullptr)
+	{
+		return;
+	}
+
+	auto effective_role = role;
+
+	if (role == AnalysisBus::SOURCE && ! slot->claim(this))
+	{
+		// Another instance already publishes under this name, listen to it instead of competing.
+		effective_role = AnalysisBus::FOLLOWER;
+	}
+
+	analysis_bus_role_.store(effective_role);
+}
+
+AnalysisBus::role WhooshGeneratorAudioProcessor::get_analysis_bus_role() const
+{
+	return static_cast<AnalysisBus::role>(analysis_bus_role_.load());
+}
+
+AnalysisBus::role WhooshGeneratorAudioProcessor::get_requested_analysis_bus_role() const
+{
+	return static_cast<AnalysisBus::role>(analysis_bus_requested_role_.load());
+}
+
+String WhooshGeneratorAudioProcessor::get_analysis_bus_name() const
+{
+	const auto* slot = analysis_bus_slot_.load();
+	return (slot != nullptr) ? slot->name : String();
+}
+
+bool WhooshGeneratorAudioProcessor::follow_analysis_bus()
+{
+	auto* slot = analysis_bus_slot_.load(std::memory_order_acquire);
+	AnalysisBus::Frame frame;
+
+	const bool is_follower = slot != nullptr
+		&& analysis_bus_role_.load(std::memory_order_relaxed) == AnalysisBus::FOLLOWER;
+
+	// A missing or stale source falls back to local analysis for this block.
+	const bool has_frame = is_follower
+		&& slot->read(frame, analysis_bus_max_staleness_in_ms_)
+		&& frame.number_of_values == static_cast<int>(bus_analyzers_.size());
+
+	if (is_follower && ! has_frame)
+	{
+		reclaim_analysis_bus();
+	}
+
+	for (size_t index = 0; index < bus_analyzers_.size(); ++index)
+	{
+		bus_analyzers_[index]->set_uses_bus_value(has_frame);
+
+		if (has_frame)
+		{
+			bus_analyzers_[index]->set_last_value(frame.values[index]);
+		}
+	}
+	return has_frame;
+}
+
+void WhooshGeneratorAudioProcessor::reclaim_analysis_bus()
+{
+	// Tried, never waited for: set_analysis_bus() holds the lock while it swaps the slot and the role.
+	const SpinLock::ScopedTryLockType lock(analysis_bus_lock_);
+
+	if (! lock.isLocked()
+		|| analysis_bus_requested_role_.load(std::memory_order_relaxed) != AnalysisBus::SOURCE
+		|| analysis_bus_role_.load(std::memory_order_relaxed) != AnalysisBus::FOLLOWER)
+	{
+		return;
+	}
+
+	// Only succeeds once the publisher released the slot, so a live but stalled one keeps it.
+	auto* slot = analysis_bus_slot_.load(std::memory_order_acquire);
+	if (slot != nullptr && slot->claim(this))
+	{
+		analysis_bus_role_.store(AnalysisBus::SOURCE);
+	}
+}
+
+void WhooshGeneratorAudioProcessor::publish_to_analysis_bus()
+{
+	auto* slot = analysis_bus_slot_.load(std::memory_order_acquire);
+
+	if (slot == nullptr || analysis_bus_role_.load(std::memory_order_relaxed) != AnalysisBus::SOURCE)
+	{
+		return;
+	}
+
+	AnalysisBus::Frame frame;
+	frame.number_of_values = jmin<int>(static_cast<int>(bus_analyzers_.size()), AnalysisBus::max_values);
+
+	for (int index = 0; index < frame.number_of_values; ++index)
+	{
+		frame.values[index] = bus_analyzers_[index]->get_last_value();
+	}
+	slot->publish(this, frame);
+}
+
+//==============================================================================
+bool WhooshGeneratorAudioProcessor::start_capture(const File& directory, const bool capture_output)
+{
+	return sidechain_capture_.start(directory, capture_output);
+}
+
+void WhooshGeneratorAudioProcessor::stop_capture()
+{
+	sidechain_capture_.stop();
+}
+
+SidechainCapture& WhooshGeneratorAudioProcessor::get_sidechain_capture()
+{
+	return sidechain_capture_;
+}
+
+const ProcessLoadMonitor& WhooshGeneratorAudioProcessor::get_process_load_monitor() const
+{
+	return process_load_monitor_;
+}
 
 //==============================================================================
 // This creates new instances of the plugin..
@@ -17,10 +17,15 @@
 #include "../Components/InParametersState.h"
 #include "../Components/VolumeAnalyzer.h"
 #include "../Components/SpectrumAnalyzer.h"
+#include "../Components/PartialOutput.h"
 #include "../Components/OutputTimer.h"
 #include "../Components/GainProcess.h"
 #include "../Components/ParameterInterface.h"
 #include "../Components/InternParametersState.h"
+#include "../Components/ParametersSmoother.h"
+#include "../Components/AnalysisBus.h"
+#include "../Components/SidechainCapture.h"
+#include "../Components/ProcessLoadMonitor.h"
 
 using namespace juce;
 
@@ -80,6 +85,7 @@ public:
 	void setCurrentProgramStateInformation(const void* data, int sizeInBytes) override;
 	//==============================================================================
 	SpectrumAnalyzer* get_spectrum_analyzer();
+	[[nodiscard]] const std::vector<Analyzer*>& get_analyzers() const;
 
 	[[nodiscard]] ParametersState* get_in_parameters() const;
 	[[nodiscard]] ParametersState* get_intern_parameters() const;
@@ -87,16 +93,37 @@ public:
 
     void set_parameters_default_value() const;
 
+	//==============================================================================
+	void set_analysis_bus(AnalysisBus::role role, const String& name);
+	// The role in effect: a requested source falls back to following a name another instance publishes.
+	[[nodiscard]] AnalysisBus::role get_analysis_bus_role() const;
+	[[nodiscard]] AnalysisBus::role get_requested_analysis_bus_role() const;
+	[[nodiscard]] String get_analysis_bus_name() const;
+
+	//==============================================================================
+	bool start_capture(const File& directory, bool capture_output);
+	void stop_capture();
+	[[nodiscard]] SidechainCapture& get_sidechain_capture();
+
+	[[nodiscard]] const ProcessLoadMonitor& get_process_load_monitor() const;
+
 private:
+	bool follow_analysis_bus();
+	// A source demoted to follower takes the slot back once its publisher is gone.
+	void reclaim_analysis_bus();
+	void publish_to_analysis_bus();
+	//==============================================================================
 	std::unique_ptr<OutParametersState> out_parameters_;
 	std::unique_ptr<InParametersState> in_parameters_;
 	std::unique_ptr<InternParametersState> intern_parameters_;
+	std::unique_ptr<ParametersSmoother> in_parameters_smoother_;
 
 	//==============================================================================
 	RecordingBuffer audioSource;
 	//==============================================================================
 	std::unique_ptr<VolumeAnalyzer> volume_analyzer_;
 	std::unique_ptr<SpectrumAnalyzer> spectrum_analyzer_;
+	std::vector<std::unique_ptr<PartialOutput>> partial_outputs_;
 
 	std::unique_ptr<GainProcess> gain_processor_;
 
@@ -104,9 +131,24 @@ private:
 	std::list<AudioChainElement*> sidechain_input_processing_chain_;
 	std::list<AudioChainElement*> input_processing_chain_;
 
+	ProcessLoadMonitor process_load_monitor_;
+
 	std::vector<Analyzer*> analyzers_;
+	// What the analysis bus carries, in frame order.
+	std::vector<Analyzer*> bus_analyzers_;
 
     std::vector<std::unique_ptr<ParameterInterface>> parameters_;
+	//==============================================================================
+	SharedResourcePointer<AnalysisBus> analysis_bus_;
+	// Also holds the name: null when none is set.
+	std::atomic<AnalysisBus::Slot*> analysis_bus_slot_{nullptr};
+	std::atomic<int> analysis_bus_role_{AnalysisBus::LOCAL};
+	std::atomic<int> analysis_bus_requested_role_{AnalysisBus::LOCAL};
+	// Held by set_analysis_bus(), only tried by the audio thread.
+	SpinLock analysis_bus_lock_;
+	double analysis_bus_max_staleness_in_ms_ = AnalysisBus::default_max_staleness_in_ms;
+	//==============================================================================
+	SidechainCapture sidechain_capture_;
 	//==============================================================================
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WhooshGeneratorAudioProcessor)
 };